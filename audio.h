@@ -0,0 +1,138 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include <SFML/Audio.hpp>
+#include <bits/stdc++.h>
+
+#include "buffer.h"
+#include "game.h"
+
+/*
+    Sound effects mixer
+    - a fixed pool of voices, all made once; an effect takes a voice that is not playing,
+      a voice that is playing is never restarted or cut off
+    - the game thread only queues triggers, the sounds are started by whoever calls update(), once per frame
+    - all the triggers of an effect queued since the last update are played once, and an effect does not
+      start again before its minimum interval nor on more voices than it is allowed
+*/
+
+enum
+{
+    SFX_MOVEMENT,
+    SFX_ROTATE,
+    SFX_HARD_DROP,
+    SFX_HOLD,
+    SFX_COUNT
+};
+
+const int SFX_VOICES = 8;
+
+struct sfxMixer
+{
+    sf::SoundBuffer buffers[SFX_COUNT];
+    sf::Sound voices[SFX_VOICES];
+    int owner[SFX_VOICES]; // effect whose buffer the voice holds, -1 if none yet
+    std::chrono::steady_clock::time_point lastPlayed[SFX_COUNT];
+    std::chrono::steady_clock::duration minInterval[SFX_COUNT];
+    int maxVoices[SFX_COUNT];
+    spscQueue<unsigned char, 256> triggers;
+    std::atomic<bool> enabled;
+    long long played, coalesced, limited; // statistics
+
+    sfxMixer()
+    {
+        buffers[SFX_MOVEMENT].loadFromFile("audio/Movement.wav");
+        buffers[SFX_ROTATE].loadFromFile("audio/Rotate.wav");
+        buffers[SFX_HARD_DROP].loadFromFile("audio/HardDrop.wav");
+        buffers[SFX_HOLD].loadFromFile("audio/Hold.wav");
+        for (int v = 0; v < SFX_VOICES; v++)
+            owner[v] = -1;
+
+        // fast repeats (DAS, bots) would be a buzz, they are spaced out instead
+        minInterval[SFX_MOVEMENT] = std::chrono::milliseconds(40), maxVoices[SFX_MOVEMENT] = 2;
+        minInterval[SFX_ROTATE] = std::chrono::milliseconds(30), maxVoices[SFX_ROTATE] = 2;
+        minInterval[SFX_HARD_DROP] = std::chrono::milliseconds(0), maxVoices[SFX_HARD_DROP] = 3;
+        minInterval[SFX_HOLD] = std::chrono::milliseconds(0), maxVoices[SFX_HOLD] = 1;
+        for (int e = 0; e < SFX_COUNT; e++)
+            lastPlayed[e] = std::chrono::steady_clock::time_point();
+
+        enabled = 1;
+        played = 0, coalesced = 0, limited = 0;
+    }
+
+    // game thread: ask for an effect, never waits; the queue is emptied every frame, if it is full the effect is dropped
+    void trigger(const int &effect)
+    {
+        if (enabled)
+            triggers.push(effect);
+    }
+
+    // game thread: queue the effects whose counters changed in g since seen, then update seen
+    void triggerGame(const Game &g, int seen[SFX_COUNT])
+    {
+        int now[SFX_COUNT] = {g.movementSounds, g.rotateSounds, g.hardDropSounds, g.holdSounds};
+        for (int e = 0; e < SFX_COUNT; e++)
+        {
+            if (now[e] != seen[e])
+                trigger(e);
+            seen[e] = now[e];
+        }
+    }
+
+    // start a voice for the effect, return 0 if none is free or the effect has all it is allowed
+    bool play(const int &effect)
+    {
+        int voice = -1, busy = 0;
+        for (int v = 0; v < SFX_VOICES; v++)
+        {
+            if (voices[v].getStatus() != sf::Sound::Stopped)
+            {
+                if (owner[v] == effect)
+                    busy++;
+            }
+            // a free voice that already holds this buffer saves a setBuffer
+            else if (voice == -1 || (owner[v] == effect && owner[voice] != effect))
+                voice = v;
+        }
+        if (voice == -1 || busy >= maxVoices[effect])
+            return 0;
+        if (owner[voice] != effect)
+        {
+            voices[voice].setBuffer(buffers[effect]);
+            owner[voice] = effect;
+        }
+        voices[voice].play();
+        return 1;
+    }
+
+    // audio side, once per frame: play what was queued
+    void update()
+    {
+        bool wanted[SFX_COUNT] = {};
+        unsigned char effect;
+        while (triggers.pop(effect))
+        {
+            if (wanted[effect])
+                coalesced++;
+            wanted[effect] = 1;
+        }
+        if (!enabled)
+            return;
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        for (int e = 0; e < SFX_COUNT; e++)
+        {
+            if (!wanted[e])
+                continue;
+            if (now - lastPlayed[e] < minInterval[e] || !play(e))
+            {
+                limited++;
+                continue;
+            }
+            lastPlayed[e] = now;
+            played++;
+        }
+    }
+};
+
+#endif
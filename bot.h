@@ -0,0 +1,257 @@
+#ifndef BOT_H
+#define BOT_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+#include "placement.h"
+#include "replay.h"
+
+/*
+    Heuristic bot
+    For every placement of the current tetromino (and of the one it could hold), the board after the lock is rated
+    by a weighted sum of features; the bot then presses the fewest keys leading to the best one (finesse.h),
+    one input per update, through updateGame() like a player would
+*/
+
+enum
+{
+    FEATURE_HEIGHT,    // sum of the column heights
+    FEATURE_HOLES,     // empty cells with a block somewhere above them
+    FEATURE_BUMPINESS, // sum of the height differences between neighbour columns
+    FEATURE_WELLS,     // sum of the depths of the columns lower than both neighbours
+    FEATURE_CLEARS,    // lines cleared by the placement
+    FEATURE_COUNT
+};
+
+const char *FEATURE_NAMES[FEATURE_COUNT] = {"height", "holes", "bumpiness", "wells", "clears"};
+
+struct botWeights
+{
+    double w[FEATURE_COUNT];
+    botWeights()
+    {
+        // hand tuned starting point
+        w[FEATURE_HEIGHT] = -0.51, w[FEATURE_HOLES] = -0.36, w[FEATURE_BUMPINESS] = -0.18;
+        w[FEATURE_WELLS] = -0.1, w[FEATURE_CLEARS] = 0.76;
+    }
+};
+
+void getFeatures(const board &b, const int &cleared, double features[FEATURE_COUNT])
+{
+    int height[COLUMN];
+    int holes = 0;
+    for (int j = 0; j < COLUMN; j++)
+    {
+        height[j] = 0;
+        for (int i = 0; i < ROWS; i++)
+        {
+            if (b[i][j])
+            {
+                if (!height[j])
+                    height[j] = ROWS - i;
+            }
+            else if (height[j])
+                holes++;
+        }
+    }
+
+    int total = 0, bumpiness = 0, wells = 0;
+    for (int j = 0; j < COLUMN; j++)
+    {
+        total += height[j];
+        if (j + 1 < COLUMN)
+            bumpiness += std::abs(height[j] - height[j + 1]);
+        int left = j ? height[j - 1] : ROWS, right = j + 1 < COLUMN ? height[j + 1] : ROWS;
+        wells += std::max(0, std::min(left, right) - height[j]);
+    }
+
+    features[FEATURE_HEIGHT] = total;
+    features[FEATURE_HOLES] = holes;
+    features[FEATURE_BUMPINESS] = bumpiness;
+    features[FEATURE_WELLS] = wells;
+    features[FEATURE_CLEARS] = cleared;
+}
+
+// rate locking t on b, scratch is reused to avoid allocating a board for every placement
+double ratePlacement(const board &b, const Tetromino &t, const botWeights &w, board &scratch)
+{
+    scratch = b;
+    lockTetromino(t, scratch);
+    int cleared = clearLines(scratch);
+    if (isEnd(scratch))
+        return -1e9;
+    double features[FEATURE_COUNT];
+    getFeatures(scratch, cleared, features);
+    double rating = 0;
+    for (int i = 0; i < FEATURE_COUNT; i++)
+        rating += w.w[i] * features[i];
+    return rating;
+}
+
+// the best placement of this type; return -inf if there is none
+double bestPlacement(const board &b, const int &type, const botWeights &w, board &scratch, Tetromino &target)
+{
+    std::vector<Tetromino> placements = getPlacements(b, type);
+    double best = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < placements.size(); i++)
+    {
+        double rating = ratePlacement(b, placements[i], w, scratch);
+        if (rating > best)
+        {
+            best = rating;
+            target = placements[i];
+        }
+    }
+    return best;
+}
+
+struct botPlayer
+{
+    botWeights weights;
+    std::vector<int> plan; // keys to press to reach the chosen placement, then a hard drop
+    size_t step;
+    bool holding;          // the key of the current step has been pressed and is still held
+    int expectedY;         // while waiting for gravity, the row the pivot block should reach
+    long long planned;     // which tetromino the plan was made for
+    board scratch;
+
+    botPlayer(const botWeights &_weights = botWeights())
+    {
+        weights = _weights;
+        step = 0, holding = 0, expectedY = -1, planned = -1;
+        scratch = board(ROWS, std::vector<int>(COLUMN, 0));
+    }
+};
+
+// choose where the new tetromino goes; return 1 if the bot would rather hold first
+bool makePlan(botPlayer &bot, const Game &g)
+{
+    Tetromino target, other;
+    double rating = bestPlacement(g.boardStates, g.tetra.color, bot.weights, bot.scratch, target);
+    if (!g.isHeld)
+    {
+        int type = g.heldTetromino == -1 ? g.next.peek(0) : g.heldTetromino;
+        if (type != g.tetra.color && bestPlacement(g.boardStates, type, bot.weights, bot.scratch, other) > rating)
+            return 1;
+    }
+
+    // every placement found by getPlacements() can be reached with the keys, but just in case, drop where it is
+    bool found;
+    bot.plan = finessePath(g.boardStates, g.tetra, target, found);
+    if (!found)
+        bot.plan.clear();
+    bot.step = 0;
+    bot.holding = 0;
+    bot.expectedY = -1;
+    return 0;
+}
+
+// the input the bot gives for the next update of the game
+gameInput botInput(botPlayer &bot, const Game &g)
+{
+    gameInput in;
+    if (!g.isPlaying || !g.gameStarted)
+        return in;
+
+    long long current = ((long long)g.locked * 64 + g.played) * 8 + g.heldTetromino + 1;
+    if (current != bot.planned)
+    {
+        if (makePlan(bot, g))
+        {
+            in.hold = 1;
+            return in;
+        }
+        bot.planned = current;
+    }
+    while (bot.step < bot.plan.size())
+    {
+        Tetromino moved = g.tetra;
+        switch (bot.plan[bot.step])
+        {
+        case KEY_DAS_LEFT:
+        case KEY_DAS_RIGHT:
+            // held until the tetromino stops moving
+            if (applyKey(moved, g.boardStates, bot.plan[bot.step] == KEY_DAS_LEFT ? KEY_LEFT : KEY_RIGHT))
+            {
+                in.dx = moved.block[1].x - g.tetra.block[1].x;
+                in.autoRepeat = bot.holding;
+                bot.holding = 1;
+                return in;
+            }
+            break;
+        case KEY_LEFT:
+            in.dx = -1;
+            break;
+        case KEY_RIGHT:
+            in.dx = 1;
+            break;
+        case KEY_CW:
+            in.rotate_cw = 1;
+            break;
+        case KEY_CCW:
+            in.rotate_ccw = 1;
+            break;
+        case KEY_SOFT_DROP:
+            // held until it lands, then released before gravity locks it
+            if (applyKey(moved, g.boardStates, KEY_DOWN))
+            {
+                in.softDrop = 1;
+                in.keyRelease = 0, in.softDropRelease = 0;
+                in.autoRepeat = bot.holding;
+                bot.holding = 1;
+                return in;
+            }
+            in.keyRelease = 1, in.softDropRelease = 1;
+            break;
+        case KEY_DOWN:
+            // there is no input to move down by one, soft drop and wait for gravity
+            if (bot.expectedY == -1)
+                bot.expectedY = g.tetra.block[1].y + 1;
+            if (g.tetra.block[1].y < bot.expectedY)
+            {
+                in.softDrop = 1;
+                in.keyRelease = 0, in.softDropRelease = 0;
+                in.autoRepeat = bot.holding;
+                bot.holding = 1;
+                return in;
+            }
+            bot.expectedY = -1;
+            in.keyRelease = 1, in.softDropRelease = 1;
+            break;
+        }
+        int key = bot.plan[bot.step++];
+        bot.holding = 0;
+        // a held key that is done gives way to the next one in the same update
+        if (key == KEY_DAS_LEFT || key == KEY_DAS_RIGHT || key == KEY_SOFT_DROP || key == KEY_DOWN)
+            continue;
+        return in;
+    }
+
+    in.hardDrop = 1;
+    in.keyRelease = 1, in.softDropRelease = 1;
+    bot.step++;
+    return in;
+}
+
+// play a whole game with the bot at a fixed tick, until it tops out or has locked maxPieces tetrominos
+// if record is given, it receives the inputs too, so the game can be replayed when dt is REPLAY_TICK
+Game playGame(botPlayer &bot, const unsigned long long &seed, const int &maxPieces, const double &dt, replay *record = nullptr)
+{
+    Game g(seed);
+    if (record)
+        *record = replay(seed);
+    while (g.locked < maxPieces)
+    {
+        gameInput in = botInput(bot, g);
+        if (record)
+            record->inputs.push_back(encodeInput(in));
+        updateGame(g, in, dt);
+        if (!g.isPlaying)
+            break;
+    }
+    return g;
+}
+
+#endif
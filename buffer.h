@@ -0,0 +1,86 @@
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <bits/stdc++.h>
+
+/*
+    Triple buffer: one thread writes snapshots, another thread reads the latest complete one
+    Neither side ever waits for the other:
+    - the writer fills its own back buffer, then swaps it with the middle one
+    - the reader swaps its front buffer with the middle one only if a new snapshot has been published
+*/
+template <typename T>
+struct tripleBuffer
+{
+    static const int FRESH = 4; // set on the middle index when it holds a snapshot the reader has not seen
+
+    T buffers[3];
+    int back, front;          // owned by the writer and the reader respectively
+    std::atomic<int> middle;  // shared, index of the middle buffer plus the FRESH flag
+
+    tripleBuffer(const T &initial)
+    {
+        for (int i = 0; i < 3; i++)
+            buffers[i] = initial;
+        back = 0, middle = 1, front = 2;
+    }
+
+    // writer: the buffer to fill, its old content is some earlier snapshot
+    T &writeBuffer()
+    {
+        return buffers[back];
+    }
+
+    // writer: make the filled buffer the latest snapshot
+    void publish()
+    {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & 3;
+    }
+
+    // reader: the latest published snapshot, stays valid until the next call
+    const T &read()
+    {
+        if (middle.load(std::memory_order_relaxed) & FRESH)
+            front = middle.exchange(front, std::memory_order_acq_rel) & 3;
+        return buffers[front];
+    }
+};
+
+/*
+    Bounded single producer, single consumer queue, also without locks
+    push() fails when the queue is full, pop() fails when it is empty
+*/
+template <typename T, int N>
+struct spscQueue
+{
+    T items[N];
+    std::atomic<int> head, tail; // head: next item to pop, tail: next free slot
+
+    spscQueue()
+    {
+        head = 0, tail = 0;
+    }
+
+    bool push(const T &item)
+    {
+        int t = tail.load(std::memory_order_relaxed);
+        int next = (t + 1) % N;
+        if (next == head.load(std::memory_order_acquire))
+            return 0;
+        items[t] = item;
+        tail.store(next, std::memory_order_release);
+        return 1;
+    }
+
+    bool pop(T &item)
+    {
+        int h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return 0;
+        item = items[h];
+        head.store((h + 1) % N, std::memory_order_release);
+        return 1;
+    }
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+    Clips: render replays or bot games offscreen (exporter.h), as PNG sequences or raw video, as fast as possible
+    The frames are drawn by drawGame(), exactly like the window of main()
+
+    Usage: clips DIR [--replays FILE] [--bots N] [--pieces P] [--seed S] [--save FILE]
+                     [--format png|raw] [--encoders T] [--every K]
+    - --replays: every game of a replay file (replay.h) becomes a clip
+    - --bots: N bot games of at most P tetrominos (default: 4 games, 100 tetrominos), seeded from S (default: 1),
+      --save also appends them to a replay file
+    - --format: default png; --encoders: encoder threads, default one per core; --every: keep one tick out of K
+      (default: 1, 60 frames per second of game)
+    - run from the game folder, the textures and the font are loaded from there
+    - on a machine without a display, run it under a virtual one, e.g. xvfb-run ./clips out --bots 100
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "bot.h"
+#include "exporter.h"
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: clips DIR [--replays FILE] [--bots N] [--pieces P] [--seed S] [--save FILE] [--format png|raw] [--encoders T] [--every K]\n";
+        return 1;
+    }
+    std::string directory = argv[1], replayFile, saveFile;
+    int bots = 0, pieces = 100, encoders = std::max(1u, std::thread::hardware_concurrency()), every = 1;
+    int format = FRAME_PNG;
+    unsigned long long seed = 1;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "--replays")
+            replayFile = argv[i + 1];
+        else if (arg == "--bots")
+            bots = std::max(0, atoi(argv[i + 1]));
+        else if (arg == "--pieces")
+            pieces = std::max(1, atoi(argv[i + 1]));
+        else if (arg == "--seed")
+            seed = strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--save")
+            saveFile = argv[i + 1];
+        else if (arg == "--format")
+            format = std::string(argv[i + 1]) == "raw" ? FRAME_RAW : FRAME_PNG;
+        else if (arg == "--encoders")
+            encoders = std::max(1, atoi(argv[i + 1]));
+        else if (arg == "--every")
+            every = std::max(1, atoi(argv[i + 1]));
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<replay> games;
+    if (!replayFile.empty() && !loadReplays(replayFile, games))
+        std::cerr << "cannot read all of " << replayFile << ", " << games.size() << " game(s) loaded\n";
+    if (replayFile.empty() && !bots)
+        bots = 4;
+    std::vector<replay> played(bots);
+    for (int k = 0; k < bots; k++)
+    {
+        botPlayer bot;
+        playGame(bot, seed + k, pieces, REPLAY_TICK, &played[k]);
+    }
+    if (!saveFile.empty() && !saveReplays(saveFile, played))
+        std::cerr << "cannot save " << saveFile << "\n";
+    games.insert(games.end(), played.begin(), played.end());
+
+    gameAssets assets;
+    frameExporter exporter(directory, format, encoders);
+    headlessRenderer renderer(exporter, assets);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    long long frames = 0, ticks = 0;
+    for (size_t c = 0; c < games.size(); c++)
+    {
+        int index = 0;
+        playReplay(games[c], [&](const Game &g, const size_t &t)
+                   {
+                       if (t % every == 0)
+                           renderer.render(g, c, index++);
+                   });
+        exporter.finishClip(c, index);
+        frames += index;
+        ticks += games[c].inputs.size();
+    }
+    exporter.close();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << games.size() << " clip(s), " << frames << " frames in " << std::fixed << std::setprecision(2) << elapsed << " s: "
+              << std::setprecision(0) << frames / elapsed << " frames/s, " << std::setprecision(1)
+              << ticks * REPLAY_TICK / elapsed << "x real time\n";
+    return 0;
+}
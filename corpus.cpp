@@ -0,0 +1,135 @@
+/*
+    Corpus: index a collection of replay files once (corpus.h), then search it in milliseconds
+
+    Usage:
+    - corpus build INDEX FILE...          play every game of the replay files on all cores and write the index
+    - corpus board INDEX BOARD [limit]    positions with exactly the filled cells of BOARD
+                                          (20 lines of 10 characters, '.' is an empty cell, anything else is filled)
+    - corpus height INDEX LOW HIGH [limit]  positions with a stack height between LOW and HIGH
+    - corpus holes INDEX LOW HIGH [limit]   positions with between LOW and HIGH holes
+    - corpus lines INDEX LOW HIGH [limit]   positions after between LOW and HIGH lines cleared in the game
+    - corpus topout INDEX HEIGHT [limit]    games that topped out from a stack lower than HEIGHT
+    - limit: how many results are printed (default: 10), they are all counted
+    Replays can be made by selfplay or clips --save
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "corpus.h"
+
+void printPositions(const corpusIndex &index, const std::vector<uint32_t> &found, const size_t &limit)
+{
+    for (size_t i = 0; i < found.size() && i < limit; i++)
+    {
+        uint32_t p = found[i];
+        const corpusGame &g = index.games.as<corpusGame>()[index.game.as<uint32_t>()[p]];
+        std::cout << "  " << index.files[g.file] << " game " << g.index << ", tick " << index.tick.as<uint32_t>()[p]
+                  << ", piece " << index.piece.as<uint16_t>()[p] << ": height " << (int)index.height.as<uint8_t>()[p]
+                  << ", holes " << (int)index.holes.as<uint8_t>()[p] << ", lines " << index.lines.as<uint16_t>()[p] << "\n";
+    }
+}
+
+void printGames(const corpusIndex &index, const std::vector<uint32_t> &found, const size_t &limit)
+{
+    for (size_t i = 0; i < found.size() && i < limit; i++)
+    {
+        const corpusGame &g = index.games.as<corpusGame>()[found[i]];
+        std::cout << "  " << index.files[g.file] << " game " << g.index << ": topped out from height " << (int)g.topOutHeight
+                  << " after " << g.pieces << " tetrominos, score " << g.score << ", lines " << g.lines << "\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        std::cerr << "usage: corpus build INDEX FILE... | board INDEX BOARD | height INDEX LOW HIGH | holes INDEX LOW HIGH | lines INDEX LOW HIGH | topout INDEX HEIGHT\n";
+        return 1;
+    }
+    std::string command = argv[1], directory = argv[2];
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    auto elapsed = [&]()
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if (command == "build")
+    {
+        std::vector<std::string> files(argv + 3, argv + argc);
+        int threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if (!buildCorpus(directory, files, threadCount))
+        {
+            std::cerr << "cannot write the index to " << directory << "\n";
+            return 1;
+        }
+        corpusIndex index;
+        index.open(directory);
+        std::cout << index.gameCount << " games, " << index.positions << " positions indexed in "
+                  << std::fixed << std::setprecision(0) << elapsed() << " ms\n";
+        return 0;
+    }
+
+    corpusIndex index;
+    if (!index.open(directory))
+    {
+        std::cerr << "cannot open the index in " << directory << "\n";
+        return 1;
+    }
+    double opened = elapsed();
+    start = std::chrono::steady_clock::now();
+
+    std::vector<uint32_t> found;
+    size_t limit = 10;
+    bool games = 0;
+    if (command == "board")
+    {
+        board b(ROWS, std::vector<int>(COLUMN, 0));
+        std::ifstream in(argv[3]);
+        if (!in)
+        {
+            std::cerr << "cannot open " << argv[3] << "\n";
+            return 1;
+        }
+        std::string row;
+        for (int i = 0; i < ROWS && std::getline(in, row); i++)
+            for (int j = 0; j < COLUMN && j < (int)row.size(); j++)
+                b[i][j] = row[j] != '.';
+        found = index.matchBoard(b);
+        if (argc > 4)
+            limit = atoi(argv[4]);
+    }
+    else if ((command == "height" || command == "holes" || command == "lines") && argc > 4)
+    {
+        int low = atoi(argv[3]), high = atoi(argv[4]);
+        if (command == "height")
+            found = index.heightRange(low, high);
+        else if (command == "holes")
+            found = index.holesRange(low, high);
+        else
+            found = index.linesRange(low, high);
+        if (argc > 5)
+            limit = atoi(argv[5]);
+    }
+    else if (command == "topout")
+    {
+        found = index.toppedOutBelow(atoi(argv[3]));
+        games = 1;
+        if (argc > 4)
+            limit = atoi(argv[4]);
+    }
+    else
+    {
+        std::cerr << "unknown command " << command << "\n";
+        return 1;
+    }
+    double queried = elapsed();
+
+    std::cout << found.size() << (games ? " game(s)" : " position(s)") << " found in " << std::fixed << std::setprecision(3)
+              << queried << " ms (index of " << index.positions << " positions opened in " << opened << " ms)\n";
+    if (games)
+        printGames(index, found, limit);
+    else
+        printPositions(index, found, limit);
+    return 0;
+}
@@ -0,0 +1,347 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "replay.h"
+
+/*
+    Index of a replay corpus (Linux only)
+    Every replay is played once when the index is built; after every lock, the board is a position with
+    a Zobrist hash of its filled cells and a few features. Queries then only read the index, never the replays
+    The index is a folder of columns, plain arrays of one field each, memory mapped when queried:
+    - positions, sorted by hash: hash.bin (uint64), rows.bin (uint16 x 20, bit j set if column j is filled),
+      game.bin (uint32), tick.bin (uint32), piece.bin (uint16, tetrominos locked), height.bin (uint8),
+      holes.bin (uint8), lines.bin (uint16, lines cleared in the game so far)
+    - byHeight.bin, byHoles.bin, byLines.bin: positions (uint32) sorted by stack height, by holes, by lines cleared
+    - games.bin (corpusGame), gamesByTopOut.bin: games (uint32) sorted by the height they topped out from
+    - corpus.meta: "KTCORPUS 2", the number of positions and games, then the replay files, one per line
+*/
+
+struct corpusGame
+{
+    uint32_t file, index;     // replay file, and game within that file
+    uint32_t ticks, pieces, score, lines;
+    uint8_t toppedOut;
+    uint8_t topOutHeight;     // stack height before the lock that topped out, 255 if it did not
+    uint16_t reserved;
+};
+static_assert(sizeof(corpusGame) == 28, "games must stay 28 bytes");
+
+struct corpusPosition
+{
+    uint64_t hash;
+    uint16_t rows[ROWS];
+    uint32_t game, tick;
+    uint16_t piece, lines;
+    uint8_t height, holes;
+};
+
+// random numbers for every cell, always the same ones so hashes can be compared between builds
+unsigned long long zobristKey(const int &cell)
+{
+    unsigned long long z = (cell + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// only which cells are filled matters, not by which tetromino
+unsigned long long boardHash(const board &b)
+{
+    unsigned long long h = 0;
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            if (b[i][j])
+                h ^= zobristKey(i * COLUMN + j);
+    return h;
+}
+
+int countHoles(const board &b)
+{
+    int holes = 0;
+    for (int j = 0; j < COLUMN; j++)
+    {
+        bool covered = 0;
+        for (int i = 0; i < ROWS; i++)
+        {
+            if (b[i][j])
+                covered = 1;
+            else if (covered)
+                holes++;
+        }
+    }
+    return holes;
+}
+
+void boardRows(const board &b, uint16_t rows[ROWS])
+{
+    for (int i = 0; i < ROWS; i++)
+    {
+        rows[i] = 0;
+        for (int j = 0; j < COLUMN; j++)
+            if (b[i][j])
+                rows[i] |= 1 << j;
+    }
+}
+
+// play a replay and collect its positions
+corpusGame indexReplay(const replay &r, const uint32_t &id, std::vector<corpusPosition> &positions)
+{
+    corpusGame info = {};
+    info.topOutHeight = 255;
+    int locked = 0, height = 0;
+    Game end = playReplay(r, [&](const Game &g, const size_t &t)
+                        {
+                            if (g.locked == locked)
+                                return;
+                            locked = g.locked;
+                            if (!g.isPlaying && isEnd(g.boardStates) && !info.toppedOut)
+                                info.toppedOut = 1, info.topOutHeight = height;
+                            corpusPosition p;
+                            p.hash = boardHash(g.boardStates);
+                            boardRows(g.boardStates, p.rows);
+                            p.game = id, p.tick = t;
+                            p.piece = g.locked, p.lines = g.line;
+                            p.height = height = stackHeight(g.boardStates);
+                            p.holes = countHoles(g.boardStates);
+                            positions.push_back(p);
+                        });
+    info.ticks = r.inputs.size();
+    info.pieces = end.locked, info.score = end.score, info.lines = end.line;
+    return info;
+}
+
+template <typename T>
+bool writeColumn(const std::string &path, const std::vector<T> &column)
+{
+    FILE *f = fopen(path.c_str(), "wb");
+    if (!f)
+        return 0;
+    fwrite(column.data(), sizeof(T), column.size(), f);
+    return fclose(f) == 0;
+}
+
+// play every game of the replay files on threadCount threads and write the index to directory
+bool buildCorpus(const std::string &directory, const std::vector<std::string> &files, const int &threadCount)
+{
+    std::vector<replay> replays;
+    std::vector<corpusGame> games;
+    for (size_t f = 0; f < files.size(); f++)
+    {
+        size_t first = replays.size();
+        if (!loadReplays(files[f], replays))
+            std::cerr << "cannot read all of " << files[f] << "\n";
+        for (size_t i = first; i < replays.size(); i++)
+        {
+            corpusGame info = {};
+            info.file = f, info.index = i - first;
+            games.push_back(info);
+        }
+    }
+
+    std::vector<std::vector<corpusPosition>> found(replays.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        size_t i;
+        while ((i = next++) < replays.size())
+        {
+            corpusGame info = indexReplay(replays[i], i, found[i]);
+            info.file = games[i].file, info.index = games[i].index;
+            games[i] = info;
+            std::vector<unsigned short>().swap(replays[i].inputs);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    std::vector<corpusPosition> positions;
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        positions.insert(positions.end(), found[i].begin(), found[i].end());
+        std::vector<corpusPosition>().swap(found[i]);
+    }
+    std::sort(positions.begin(), positions.end(), [](const corpusPosition &a, const corpusPosition &b)
+              { return a.hash != b.hash ? a.hash < b.hash : a.game != b.game ? a.game < b.game : a.tick < b.tick; });
+
+    size_t n = positions.size();
+    std::vector<uint64_t> hash(n);
+    std::vector<uint16_t> rows(n * ROWS), piece(n), lines(n);
+    std::vector<uint32_t> game(n), tick(n), byHeight(n), byHoles(n), byLines(n), byTopOut(games.size());
+    std::vector<uint8_t> height(n), holes(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        const corpusPosition &p = positions[i];
+        hash[i] = p.hash;
+        std::copy(p.rows, p.rows + ROWS, rows.begin() + i * ROWS);
+        game[i] = p.game, tick[i] = p.tick, piece[i] = p.piece, lines[i] = p.lines;
+        height[i] = p.height, holes[i] = p.holes;
+        byHeight[i] = byHoles[i] = byLines[i] = i;
+    }
+    std::vector<corpusPosition>().swap(positions);
+    std::stable_sort(byHeight.begin(), byHeight.end(), [&](const uint32_t &a, const uint32_t &b)
+                     { return height[a] < height[b]; });
+    std::stable_sort(byHoles.begin(), byHoles.end(), [&](const uint32_t &a, const uint32_t &b)
+                     { return holes[a] < holes[b]; });
+    std::stable_sort(byLines.begin(), byLines.end(), [&](const uint32_t &a, const uint32_t &b)
+                     { return lines[a] < lines[b]; });
+    for (size_t i = 0; i < games.size(); i++)
+        byTopOut[i] = i;
+    std::stable_sort(byTopOut.begin(), byTopOut.end(), [&](const uint32_t &a, const uint32_t &b)
+                     { return games[a].topOutHeight < games[b].topOutHeight; });
+
+    std::filesystem::create_directories(directory);
+    bool ok = writeColumn(directory + "/hash.bin", hash) && writeColumn(directory + "/rows.bin", rows) &&
+              writeColumn(directory + "/game.bin", game) && writeColumn(directory + "/tick.bin", tick) &&
+              writeColumn(directory + "/piece.bin", piece) && writeColumn(directory + "/lines.bin", lines) &&
+              writeColumn(directory + "/height.bin", height) && writeColumn(directory + "/holes.bin", holes) &&
+              writeColumn(directory + "/byHeight.bin", byHeight) && writeColumn(directory + "/byHoles.bin", byHoles) &&
+              writeColumn(directory + "/byLines.bin", byLines) &&
+              writeColumn(directory + "/games.bin", games) && writeColumn(directory + "/gamesByTopOut.bin", byTopOut);
+
+    std::ofstream meta(directory + "/corpus.meta");
+    meta << "KTCORPUS 2\n" << n << " " << games.size() << "\n";
+    for (size_t f = 0; f < files.size(); f++)
+        meta << files[f] << "\n";
+    meta.close();
+    return ok && meta;
+}
+
+// a whole file mapped in memory, read only
+struct mappedFile
+{
+    void *data;
+    size_t size;
+
+    mappedFile()
+    {
+        data = nullptr, size = 0;
+    }
+
+    // the mapping is unmapped by the destructor, so it has exactly one owner
+    mappedFile(const mappedFile &) = delete;
+    mappedFile &operator=(const mappedFile &) = delete;
+
+    bool open(const std::string &path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            return 0;
+        struct stat info;
+        bool ok = fstat(fd, &info) == 0;
+        size = ok ? info.st_size : 0;
+        if (ok && size)
+        {
+            data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ok = data != MAP_FAILED;
+            if (!ok)
+                data = nullptr, size = 0;
+        }
+        ::close(fd);
+        return ok;
+    }
+
+    template <typename T>
+    const T *as() const
+    {
+        return (const T *)data;
+    }
+
+    ~mappedFile()
+    {
+        if (data)
+            munmap(data, size);
+    }
+};
+
+struct corpusIndex
+{
+    size_t positions, gameCount;
+    std::vector<std::string> files;
+    mappedFile hash, rows, game, tick, piece, lines, height, holes, byHeight, byHoles, byLines, games, gamesByTopOut;
+
+    bool open(const std::string &directory)
+    {
+        std::ifstream meta(directory + "/corpus.meta");
+        std::string magic;
+        int version;
+        if (!(meta >> magic >> version >> positions >> gameCount) || magic != "KTCORPUS" || version != 2)
+            return 0;
+        std::string file;
+        std::getline(meta, file);
+        while (std::getline(meta, file))
+            files.push_back(file);
+        return hash.open(directory + "/hash.bin") && rows.open(directory + "/rows.bin") &&
+               game.open(directory + "/game.bin") && tick.open(directory + "/tick.bin") &&
+               piece.open(directory + "/piece.bin") && lines.open(directory + "/lines.bin") &&
+               height.open(directory + "/height.bin") && holes.open(directory + "/holes.bin") &&
+               byHeight.open(directory + "/byHeight.bin") && byHoles.open(directory + "/byHoles.bin") &&
+               byLines.open(directory + "/byLines.bin") && games.open(directory + "/games.bin") && gamesByTopOut.open(directory + "/gamesByTopOut.bin");
+    }
+
+    // positions with exactly these filled cells
+    std::vector<uint32_t> matchBoard(const board &b) const
+    {
+        unsigned long long h = boardHash(b);
+        uint16_t wanted[ROWS];
+        boardRows(b, wanted);
+        const uint64_t *first = hash.as<uint64_t>(), *last = first + positions;
+        std::vector<uint32_t> result;
+        // the rows are compared too, in case two boards share a hash
+        for (const uint64_t *p = std::lower_bound(first, last, h); p != last && *p == h; p++)
+            if (!memcmp(rows.as<uint16_t>() + (p - first) * ROWS, wanted, sizeof(wanted)))
+                result.push_back(p - first);
+        return result;
+    }
+
+    // positions with a feature between low and high, through the permutation sorted by that feature
+    template <typename T>
+    std::vector<uint32_t> featureRange(const mappedFile &column, const mappedFile &sorted, const int &low, const int &high) const
+    {
+        const T *value = column.as<T>();
+        const uint32_t *first = sorted.as<uint32_t>(), *last = first + positions;
+        const uint32_t *from = std::partition_point(first, last, [&](const uint32_t &i)
+                                                    { return value[i] < low; });
+        const uint32_t *to = std::partition_point(from, last, [&](const uint32_t &i)
+                                                  { return value[i] <= high; });
+        return std::vector<uint32_t>(from, to);
+    }
+
+    std::vector<uint32_t> heightRange(const int &low, const int &high) const
+    {
+        return featureRange<uint8_t>(height, byHeight, low, high);
+    }
+
+    std::vector<uint32_t> holesRange(const int &low, const int &high) const
+    {
+        return featureRange<uint8_t>(holes, byHoles, low, high);
+    }
+
+    std::vector<uint32_t> linesRange(const int &low, const int &high) const
+    {
+        return featureRange<uint16_t>(lines, byLines, low, high);
+    }
+
+    // games that topped out from a stack lower than maxHeight
+    std::vector<uint32_t> toppedOutBelow(const int &maxHeight) const
+    {
+        const corpusGame *info = games.as<corpusGame>();
+        const uint32_t *first = gamesByTopOut.as<uint32_t>(), *last = first + gameCount;
+        const uint32_t *to = std::partition_point(first, last, [&](const uint32_t &i)
+                                                  { return info[i].topOutHeight < maxHeight; });
+        return std::vector<uint32_t>(first, to);
+    }
+};
+
+#endif
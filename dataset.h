@@ -0,0 +1,299 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+
+/*
+    Training data: one fixed size record per decision, a decision being everything from the moment a tetromino
+    spawns until it is locked
+    Records go to chunk files of at most CHUNK_RECORDS records, each starting with a 64 bytes header, so a chunk can be
+    memory mapped and read as an array without parsing, e.g. with numpy:
+        dtype = np.dtype([("rows", "<u2", 20), ("scoreDelta", "<i4"), ("game", "<u4"), ("move", "<u2"),
+                          ("piece", "u1"), ("hold", "i1"), ("next", "u1", 5), ("placedPiece", "u1"),
+                          ("cells", "u1", 4), ("usedHold", "u1"), ("linesCleared", "u1")])
+        header = np.fromfile(path, dtype=np.uint64, count=8)   # header[2]: first record, header[3]: record count
+        records = np.memmap(path, dtype=dtype, mode="r", offset=64, shape=(header[3],))
+    index.bin lists every chunk: a header with the same layout (chunk = number of chunks), then one
+    (chunk number, first record, record count) triple of uint64 per chunk
+    Everything is little endian
+*/
+
+const int RECORD_PREVIEW = 5;
+const unsigned int DATASET_VERSION = 1;
+const unsigned long long CHUNK_RECORDS = 1 << 20; // 64 MB per chunk
+const int RECORD_BLOCK = 4096;                    // records handed to the writer at once
+
+struct decisionRecord
+{
+    uint16_t rows[ROWS];          // board when the tetromino spawned, bit j set if column j is filled, row 0 is the top
+    int32_t scoreDelta;           // score gained until the lock, drops and clears included
+    uint32_t game;                // game number
+    uint16_t move;                // decision number within the game
+    uint8_t piece;                // tetromino at spawn
+    int8_t hold;                  // held tetromino at spawn, -1 if none
+    uint8_t next[RECORD_PREVIEW]; // upcoming tetrominos at spawn
+    uint8_t placedPiece;          // tetromino actually locked, differs from piece if hold was used
+    uint8_t cells[4];             // where it was locked, row * COLUMN + column, sorted
+    uint8_t usedHold;
+    uint8_t linesCleared;
+};
+static_assert(sizeof(decisionRecord) == 64, "records must stay 64 bytes");
+
+struct chunkHeader
+{
+    char magic[8]; // "KTRECORD" for chunks, "KTINDEX " for the index
+    uint32_t version, recordSize;
+    uint64_t firstRecord, recordCount;
+    uint64_t chunk;
+    uint64_t reserved[3];
+};
+static_assert(sizeof(chunkHeader) == 64, "headers must stay 64 bytes");
+
+/*
+    Writes the records on a background thread
+    Producers hand over whole blocks of records; at most maxPending blocks wait in memory,
+    a producer handing over more than that waits until the writer has caught up
+*/
+struct datasetWriter
+{
+    std::string directory;
+    size_t maxPending;
+    std::deque<std::vector<decisionRecord>> pending;
+    std::mutex lock;
+    std::condition_variable notEmpty, notFull;
+    bool closing;
+    std::thread thread;
+
+    // used by the writer thread only
+    FILE *file;
+    std::vector<chunkHeader> chunks;
+    unsigned long long total;
+
+    datasetWriter(const std::string &_directory, const size_t &_maxPending = 16)
+    {
+        directory = _directory, maxPending = _maxPending;
+        closing = 0, file = nullptr, total = 0;
+        std::filesystem::create_directories(directory);
+        thread = std::thread(&datasetWriter::run, this);
+    }
+
+    ~datasetWriter()
+    {
+        close();
+    }
+
+    // hand a block of records to the writer, the block is left empty
+    void submit(std::vector<decisionRecord> &block)
+    {
+        if (block.empty())
+            return;
+        std::unique_lock<std::mutex> guard(lock);
+        notFull.wait(guard, [&]()
+                     { return pending.size() < maxPending; });
+        pending.push_back(std::vector<decisionRecord>());
+        pending.back().swap(block);
+        notEmpty.notify_one();
+    }
+
+    // write everything left and the index, then stop the thread
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (closing)
+                return;
+            closing = 1;
+        }
+        notEmpty.notify_one();
+        thread.join();
+    }
+
+    static chunkHeader makeHeader(const char *magic, const uint64_t &chunk, const uint64_t &first, const uint64_t &count)
+    {
+        chunkHeader h = {};
+        memcpy(h.magic, magic, 8);
+        h.version = DATASET_VERSION;
+        h.recordSize = sizeof(decisionRecord);
+        h.chunk = chunk, h.firstRecord = first, h.recordCount = count;
+        return h;
+    }
+
+    std::string chunkPath(const size_t &chunk)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "chunk%05zu.bin", chunk);
+        return directory + "/" + name;
+    }
+
+    // the header of the current chunk is written again with the final count when the chunk is closed
+    void closeChunk()
+    {
+        if (!file)
+            return;
+        fseek(file, 0, SEEK_SET);
+        fwrite(&chunks.back(), sizeof(chunkHeader), 1, file);
+        fclose(file);
+        file = nullptr;
+    }
+
+    void write(const std::vector<decisionRecord> &block)
+    {
+        size_t done = 0;
+        while (done < block.size())
+        {
+            if (!file || chunks.back().recordCount == CHUNK_RECORDS)
+            {
+                closeChunk();
+                chunks.push_back(makeHeader("KTRECORD", chunks.size(), total, 0));
+                file = fopen(chunkPath(chunks.size() - 1).c_str(), "wb");
+                if (!file)
+                {
+                    perror("dataset");
+                    return;
+                }
+                fwrite(&chunks.back(), sizeof(chunkHeader), 1, file);
+            }
+            size_t count = std::min((unsigned long long)(block.size() - done), CHUNK_RECORDS - chunks.back().recordCount);
+            fwrite(&block[done], sizeof(decisionRecord), count, file);
+            chunks.back().recordCount += count;
+            total += count;
+            done += count;
+        }
+    }
+
+    void run()
+    {
+        while (1)
+        {
+            std::vector<decisionRecord> block;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                notEmpty.wait(guard, [&]()
+                              { return closing || !pending.empty(); });
+                if (pending.empty())
+                    break;
+                block.swap(pending.front());
+                pending.pop_front();
+            }
+            notFull.notify_all();
+            write(block);
+        }
+        closeChunk();
+
+        FILE *index = fopen((directory + "/index.bin").c_str(), "wb");
+        if (!index)
+            return;
+        chunkHeader h = makeHeader("KTINDEX ", chunks.size(), 0, total);
+        fwrite(&h, sizeof(h), 1, index);
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            uint64_t entry[3] = {chunks[i].chunk, chunks[i].firstRecord, chunks[i].recordCount};
+            fwrite(entry, sizeof(entry), 1, index);
+        }
+        fclose(index);
+    }
+};
+
+std::atomic<uint32_t> nextGameNumber(0);
+
+/*
+    Watches a game after every update and turns each tetromino into a record
+    A decision opens when a tetromino spawns and closes when Game::locked changes
+    Records are buffered by blocks of RECORD_BLOCK before going to the writer
+*/
+struct decisionTracker
+{
+    datasetWriter *writer;
+    std::vector<decisionRecord> block;
+    decisionRecord current;
+    bool inGame;
+    int moves, locked, score, line;
+
+    decisionTracker(datasetWriter *_writer)
+    {
+        writer = _writer;
+        inGame = 0;
+        moves = 0, locked = 0, score = 0, line = 0;
+        block.reserve(RECORD_BLOCK);
+    }
+
+    ~decisionTracker()
+    {
+        flush();
+    }
+
+    // a new Game is about to be observed: the decision left open by the last one (e.g. stopped before topping out)
+    // is dropped, the next started update opens the first decision of another game number
+    void beginGame()
+    {
+        inGame = 0;
+    }
+
+    void flush()
+    {
+        writer->submit(block);
+        block.reserve(RECORD_BLOCK);
+    }
+
+    void openDecision(const Game &g)
+    {
+        uint32_t game = current.game;
+        current = decisionRecord();
+        current.game = game;
+        current.move = moves++;
+        for (int i = 0; i < ROWS; i++)
+            for (int j = 0; j < COLUMN; j++)
+                if (g.boardStates[i][j])
+                    current.rows[i] |= 1 << j;
+        current.piece = g.tetra.color;
+        current.hold = g.heldTetromino;
+        for (int i = 0; i < RECORD_PREVIEW; i++)
+            current.next[i] = g.next.peek(i);
+        locked = g.locked, score = g.score, line = g.line;
+    }
+
+    void closeDecision(const Game &g)
+    {
+        int cell[4];
+        for (int i = 0; i < 4; i++)
+            cell[i] = g.lastLocked.block[i].y * COLUMN + g.lastLocked.block[i].x;
+        std::sort(cell, cell + 4);
+        for (int i = 0; i < 4; i++)
+            current.cells[i] = cell[i];
+        current.placedPiece = g.lastLocked.color;
+        current.usedHold = current.placedPiece != current.piece || g.heldTetromino != current.hold;
+        current.scoreDelta = g.score - score;
+        current.linesCleared = g.line - line;
+        block.push_back(current);
+        if (block.size() == RECORD_BLOCK)
+            flush();
+    }
+};
+
+// call after every updateGame()
+void observeGame(decisionTracker &t, const Game &g)
+{
+    if (!t.inGame)
+    {
+        if (!g.gameStarted || !g.isPlaying)
+            return;
+        t.inGame = 1;
+        t.moves = 0;
+        t.current.game = nextGameNumber++;
+        t.openDecision(g);
+        return;
+    }
+    if (g.locked != t.locked)
+    {
+        t.closeDecision(g);
+        t.openDecision(g);
+    }
+    // game over (not a pause), the next decision starts another game
+    if (!g.isPlaying && isEnd(g.boardStates))
+        t.inGame = 0;
+}
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "render.h"
+
+/*
+    Offscreen rendering with no window, for clips of replays or bot games
+    - frames are drawn by drawGame() into one render texture and copied back right away; SFML 2 has no asynchronous
+      readback, so the render thread waits for each copy, everything after it (encoding, writing) is done elsewhere
+    - the images go to a pool of encoder threads through a bounded queue, the render thread only ever waits
+      when the encoders are that far behind
+    - PNG: one file per frame, clipNNNNN/frameNNNNNN.png
+    - raw: clipNNNNN.rgb, 8 bits RGB frames back to back, e.g.
+      ffmpeg -f rawvideo -pix_fmt rgb24 -s 640x600 -r 60 -i clip00000.rgb clip00000.mp4
+*/
+
+const int FRAME_WIDTH = 640, FRAME_HEIGHT = 600; // the window of main()
+
+enum
+{
+    FRAME_PNG,
+    FRAME_RAW
+};
+
+struct frameJob
+{
+    sf::Image image;
+    int clip, index;
+};
+
+// the encoder threads
+struct frameExporter
+{
+    std::string directory;
+    int format;
+    size_t maxJobs;
+    std::deque<frameJob> jobs;
+    std::mutex lock;
+    std::condition_variable notEmpty, notFull;
+    bool closing;
+    std::vector<std::thread> workers;
+
+    // raw clips are written in order, frames encoded early wait in pending
+    struct rawClip
+    {
+        FILE *file;
+        int next, frames; // next frame to write, and how many there are (-1 until the clip is finished)
+        std::map<int, std::vector<sf::Uint8>> pending;
+        rawClip()
+        {
+            file = nullptr, next = 0, frames = -1;
+        }
+    };
+    std::map<int, rawClip> clips;
+    std::mutex clipLock;
+
+    std::atomic<long long> written;
+
+    frameExporter(const std::string &_directory, const int &_format, const int &threadCount, const size_t &_maxJobs = 64)
+    {
+        directory = _directory, format = _format, maxJobs = _maxJobs;
+        closing = 0, written = 0;
+        std::filesystem::create_directories(directory);
+        for (int t = 0; t < threadCount; t++)
+            workers.push_back(std::thread(&frameExporter::run, this));
+    }
+
+    ~frameExporter()
+    {
+        close();
+    }
+
+    std::string clipName(const int &clip)
+    {
+        char name[32];
+        snprintf(name, sizeof(name), "clip%05d", clip);
+        return directory + "/" + name;
+    }
+
+    void submit(frameJob &job)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        notFull.wait(guard, [&]()
+                     { return jobs.size() < maxJobs; });
+        jobs.push_back(frameJob());
+        std::swap(jobs.back(), job);
+        notEmpty.notify_one();
+    }
+
+    // every frame of the clip has been submitted
+    void finishClip(const int &clip, const int &frames)
+    {
+        if (format != FRAME_RAW)
+            return;
+        std::lock_guard<std::mutex> guard(clipLock);
+        clips[clip].frames = frames;
+        flushClip(clip);
+    }
+
+    // write the frames of the clip that are next in line, close it after the last one; clipLock must be held
+    void flushClip(const int &clip)
+    {
+        rawClip &c = clips[clip];
+        while (!c.pending.empty() && c.pending.begin()->first == c.next)
+        {
+            if (!c.file)
+                c.file = fopen((clipName(clip) + ".rgb").c_str(), "wb");
+            const std::vector<sf::Uint8> &rgb = c.pending.begin()->second;
+            if (c.file)
+                fwrite(rgb.data(), 1, rgb.size(), c.file);
+            c.pending.erase(c.pending.begin());
+            c.next++;
+        }
+        if (c.frames != -1 && c.next == c.frames)
+        {
+            if (c.file)
+                fclose(c.file);
+            clips.erase(clip);
+        }
+    }
+
+    void encode(frameJob &job)
+    {
+        if (format == FRAME_PNG)
+        {
+            char name[32];
+            snprintf(name, sizeof(name), "/frame%06d.png", job.index);
+            std::string clip = clipName(job.clip);
+            std::filesystem::create_directories(clip);
+            job.image.saveToFile(clip + name);
+        }
+        else
+        {
+            // RGBA to RGB off the lock, only the write is in order
+            sf::Vector2u size = job.image.getSize();
+            const sf::Uint8 *pixels = job.image.getPixelsPtr();
+            std::vector<sf::Uint8> rgb(size.x * size.y * 3);
+            for (size_t i = 0; pixels && i < (size_t)size.x * size.y; i++)
+                rgb[i * 3] = pixels[i * 4], rgb[i * 3 + 1] = pixels[i * 4 + 1], rgb[i * 3 + 2] = pixels[i * 4 + 2];
+
+            std::lock_guard<std::mutex> guard(clipLock);
+            clips[job.clip].pending[job.index].swap(rgb);
+            flushClip(job.clip);
+        }
+        written++;
+    }
+
+    void run()
+    {
+        while (1)
+        {
+            frameJob job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                notEmpty.wait(guard, [&]()
+                              { return closing || !jobs.empty(); });
+                if (jobs.empty())
+                    break;
+                std::swap(job, jobs.front());
+                jobs.pop_front();
+            }
+            notFull.notify_one();
+            encode(job);
+        }
+    }
+
+    // encode everything left, then stop the threads
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (closing)
+                return;
+            closing = 1;
+        }
+        notEmpty.notify_all();
+        for (size_t t = 0; t < workers.size(); t++)
+            workers[t].join();
+        // clips that were never finished still get what they have
+        for (std::map<int, rawClip>::iterator it = clips.begin(); it != clips.end(); it++)
+            if (it->second.file)
+                fclose(it->second.file);
+        clips.clear();
+    }
+};
+
+// draws games offscreen and hands the frames to an exporter
+struct headlessRenderer
+{
+    sf::RenderTexture target;
+    frameExporter &exporter;
+    const gameAssets &assets;
+    screenState screen;
+
+    headlessRenderer(frameExporter &_exporter, const gameAssets &_assets) : exporter(_exporter), assets(_assets)
+    {
+        target.create(FRAME_WIDTH, FRAME_HEIGHT);
+    }
+
+    void render(const Game &g, const int &clip, const int &index)
+    {
+        drawGame(target, g, assets, screen);
+        target.display();
+        frameJob job;
+        job.image = target.getTexture().copyToImage();
+        job.clip = clip, job.index = index;
+        exporter.submit(job);
+    }
+};
+
+#endif
@@ -0,0 +1,285 @@
+#ifndef FINESSE_H
+#define FINESSE_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "placement.h"
+
+/*
+    Finesse: the fewest key presses that bring a new tetromino to a placement before the hard drop
+    - holding left or right until the wall (DAS) is a single press, like a tap or a rotation
+    - on an open board the answer only depends on the type, the rotation and the column,
+      so it is computed once for every one of them (getFinesseTable)
+    - when the stack is in the way, a breadth first search over the same keys on the real board is used instead,
+      with soft drop and single steps down so tucks and spins can be reached too
+*/
+
+enum
+{
+    KEY_DAS_LEFT,
+    KEY_DAS_RIGHT,
+    KEY_LEFT,
+    KEY_RIGHT,
+    KEY_CW,
+    KEY_CCW,
+    KEY_SOFT_DROP, // down until it lands
+    KEY_DOWN,      // down by one
+    KEY_COUNT
+};
+
+// press a key, return 0 if it does nothing or would lock the tetromino where it is
+bool applyKey(Tetromino &t, const board &b, const int &key)
+{
+    Tetromino before = t;
+    switch (key)
+    {
+    case KEY_DAS_LEFT:
+    case KEY_DAS_RIGHT:
+    {
+        Tetromino last;
+        do
+        {
+            last = t;
+            moveHorizontal(t, b, key == KEY_DAS_LEFT ? -1 : 1);
+        } while (t.block[1].x != last.block[1].x);
+        break;
+    }
+    case KEY_LEFT:
+        moveHorizontal(t, b, -1);
+        break;
+    case KEY_RIGHT:
+        moveHorizontal(t, b, 1);
+        break;
+    case KEY_CW:
+    case KEY_CCW:
+        rotateTetromino(t, b, key == KEY_CW);
+        break;
+    case KEY_SOFT_DROP:
+    {
+        Tetromino last = t;
+        dropTetromino(t, last, b);
+        t = last;
+        break;
+    }
+    case KEY_DOWN:
+        for (int i = 0; i < 4; i++)
+            t.block[i].y++;
+        break;
+    }
+    if (!isValidPotision(t, b))
+    {
+        t = before;
+        return 0;
+    }
+    return shapeKey(t) != shapeKey(before) || t.block[1].x != before.block[1].x || t.block[1].y != before.block[1].y;
+}
+
+// where the tetromino ends up with a hard drop
+unsigned int landingKey(Tetromino t, const board &b)
+{
+    Tetromino last = t;
+    dropTetromino(t, last, b);
+    return cellsKey(last);
+}
+
+// the 4 shapes of a type, from the spawn one and turning clockwise
+void getRotations(const int &type, long long shapes[4])
+{
+    Tetromino t = getTetromino(type);
+    for (int r = 0; r < 4; r++)
+    {
+        shapes[r] = shapeKey(t);
+        // turning around the second block alone, away from any wall
+        point origin = t.block[1];
+        for (int i = 0; i < 4; i++)
+        {
+            int x = t.block[i].x, y = t.block[i].y;
+            t.block[i].x = origin.x - y + origin.y;
+            t.block[i].y = origin.y + x - origin.x;
+        }
+    }
+}
+
+int getRotation(const Tetromino &t)
+{
+    long long shapes[4];
+    getRotations(t.color, shapes);
+    long long shape = shapeKey(t);
+    for (int r = 0; r < 4; r++)
+        if (shapes[r] == shape)
+            return r;
+    return -1;
+}
+
+int getColumn(const Tetromino &t)
+{
+    int left = COLUMN;
+    for (int i = 0; i < 4; i++)
+        left = std::min(left, t.block[i].x);
+    return left;
+}
+
+/*
+    Shortest key sequence from t to a hard drop onto the cells of target, found is set to 0 if there is none
+    The sequence may also end with a rotation that does not fit, which locks the tetromino on the spot
+    If target is 0, every placement is searched and reached receives (cells, keys) for each of them instead
+*/
+std::vector<int> searchFinesse(const board &b, const Tetromino &t, const unsigned int &target, const int &keyCount, bool &found,
+                               std::vector<std::pair<unsigned int, std::vector<int>>> *reached = nullptr)
+{
+    found = 0;
+    long long shapes[4];
+    getRotations(t.color, shapes);
+    bool visited[4][ROWS * COLUMN] = {};
+    std::vector<Tetromino> queue;
+    std::vector<int> parent, parentKey;
+    std::vector<unsigned int> landed;
+    queue.reserve(4 * ROWS * COLUMN);
+
+    auto pathTo = [&](int index)
+    {
+        std::vector<int> path;
+        for (; index > 0; index = parent[index])
+            path.push_back(parentKey[index]);
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+    auto visit = [&](const Tetromino &next, const int &from, const int &key)
+    {
+        long long shape = shapeKey(next);
+        int s = 0;
+        while (s < 4 && shapes[s] != shape)
+            s++;
+        if (s == 4)
+            return;
+        bool &seen = visited[s][next.block[1].y * COLUMN + next.block[1].x];
+        if (seen)
+            return;
+        seen = 1;
+        queue.push_back(next);
+        parent.push_back(from), parentKey.push_back(key);
+    };
+
+    if (!isValidPotision(t, b))
+        return std::vector<int>();
+    visit(t, -1, -1);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        unsigned int key = landingKey(queue[head], b);
+        if (key == target)
+        {
+            found = 1;
+            return pathTo(head);
+        }
+        if (reached && std::find(landed.begin(), landed.end(), key) == landed.end())
+        {
+            landed.push_back(key);
+            reached->push_back(std::make_pair(key, pathTo(head)));
+        }
+        for (int k = 0; k < keyCount; k++)
+        {
+            Tetromino next = queue[head];
+            if (applyKey(next, b, k))
+                visit(next, head, k);
+            else if ((k == KEY_CW || k == KEY_CCW) && target && cellsKey(queue[head]) == target)
+            {
+                // a rotation that does not fit locks the tetromino where it is, like in the game
+                found = 1;
+                std::vector<int> path = pathTo(head);
+                path.push_back(k);
+                return path;
+            }
+        }
+    }
+    return std::vector<int>();
+}
+
+// the open board answer for every type, rotation and leftmost column
+struct finesseTable
+{
+    std::vector<int> keys[7][4][COLUMN];
+    bool known[7][4][COLUMN];
+
+    finesseTable()
+    {
+        memset(known, 0, sizeof(known));
+        board empty(ROWS, std::vector<int>(COLUMN, 0));
+        for (int type = 0; type < 7; type++)
+        {
+            // soft drop and steps down never help on an open board
+            bool found;
+            std::vector<std::pair<unsigned int, std::vector<int>>> reached;
+            searchFinesse(empty, getTetromino(type), 0, KEY_SOFT_DROP, found, &reached);
+
+            // every rotation and column, even the symmetric ones, gets the shortest way to its cells
+            for (size_t i = 0; i < reached.size(); i++)
+            {
+                Tetromino t = getTetromino(type);
+                for (size_t k = 0; k < reached[i].second.size(); k++)
+                    applyKey(t, empty, reached[i].second[k]);
+                for (int r = 0; r < 4; r++)
+                {
+                    Tetromino shape = t;
+                    for (int k = 0; k < r; k++)
+                        applyKey(shape, empty, KEY_CW);
+                    for (int dx = -COLUMN; dx <= COLUMN; dx++)
+                    {
+                        Tetromino moved = shape;
+                        for (int j = 0; j < 4; j++)
+                            moved.block[j].x += dx;
+                        if (!isValidPotision(moved, empty) || landingKey(moved, empty) != reached[i].first)
+                            continue;
+                        int rotation = getRotation(moved), column = getColumn(moved);
+                        if (rotation >= 0 && !known[type][rotation][column])
+                            known[type][rotation][column] = 1, keys[type][rotation][column] = reached[i].second;
+                    }
+                }
+            }
+        }
+    }
+};
+
+const finesseTable &getFinesseTable()
+{
+    static const finesseTable table;
+    return table;
+}
+
+/*
+    The fewest keys from t to a hard drop onto target's cells on this board
+    The table is tried first when t has just spawned, and checked on the real board; found is 0 if target cannot be reached
+*/
+std::vector<int> finessePath(const board &b, const Tetromino &t, const Tetromino &target, bool &found)
+{
+    unsigned int goal = cellsKey(target);
+    if (cellsKey(t) == cellsKey(getTetromino(t.color)))
+    {
+        int rotation = getRotation(target), column = getColumn(target);
+        const finesseTable &table = getFinesseTable();
+        if (rotation >= 0 && table.known[t.color][rotation][column])
+        {
+            const std::vector<int> &keys = table.keys[t.color][rotation][column];
+            Tetromino moved = t;
+            bool ok = 1;
+            for (size_t k = 0; k < keys.size() && ok; k++)
+                ok = applyKey(moved, b, keys[k]);
+            if (ok && landingKey(moved, b) == goal)
+            {
+                found = 1;
+                return keys;
+            }
+        }
+    }
+    return searchFinesse(b, t, goal, KEY_COUNT, found);
+}
+
+// how many keys a new tetromino needs to end up as target, -1 if it cannot
+int finesseCost(const board &b, const Tetromino &target)
+{
+    bool found;
+    std::vector<int> keys = finessePath(b, getTetromino(target.color), target, found);
+    return found ? keys.size() : -1;
+}
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef GAME_H
+#define GAME_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "finesse.h"
+#include "operation.h"
+#include "pieceQueue.h"
+
+// what the player did since the last update
+struct gameInput
+{
+    int dx, rotate_cw, rotate_ccw;
+    bool softDrop, softDropRelease, hardDrop, hold, keyRelease;
+    bool togglePause, pause, resume;
+    bool autoRepeat; // the key is still held from an earlier press, it does not count as a new one
+    gameInput()
+    {
+        dx = 0, rotate_cw = 0, rotate_ccw = 0;
+        softDrop = 0, softDropRelease = 0, hardDrop = 0, hold = 0, keyRelease = 0;
+        togglePause = 0, pause = 0, resume = 0;
+        autoRepeat = 0;
+    }
+};
+
+// the whole state of one game, everything the game loop needs apart from the window and the audio
+struct Game
+{
+    // tetra: the current tetromino potision
+    // prev: the previous potision, served as a backup whenever the current potision is invalid
+    Tetromino tetra, prev;
+
+    // Represent the game's state
+    board boardStates;
+
+    // Game's time
+    double timer, delay, defaultDelay;
+
+    // The upcoming tetrominos, and how many have been taken so far
+    pieceQueue next;
+    int played;
+    unsigned long long seed; // state of the random generator for everything else, like garbage holes
+
+    // Hold
+    int hold, isHeld, heldTetromino;
+
+    // Score
+    int score, level, line;
+    int locked; // tetrominos locked so far
+    Tetromino lastLocked; // where the last one went
+
+    // Finesse: keys pressed for the current tetromino, and tetrominos locked with more keys than needed
+    // judging a lock costs a search, so only a game that shows the counter turns trackFinesse on
+    int keys, finesseFaults;
+    bool trackFinesse;
+
+    // Other necessary variables
+    bool gameStarted, isPlaying, isReleased, hardDrop, softDrop;
+    int countdown;
+
+    // Sound effects triggered so far, whoever plays the audio compares them with the last values it has seen
+    int movementSounds, rotateSounds, hardDropSounds, holdSounds;
+
+    Game(const unsigned long long &_seed = std::rand())
+    {
+        boardStates = board(ROWS, std::vector<int>(COLUMN, 0));
+        timer = 0, delay = DEFAULT_DELAY, defaultDelay = DEFAULT_DELAY;
+
+        next = pieceQueue(_seed);
+        played = 1;
+        seed = _seed ^ 0x9e3779b97f4a7c15ULL;
+        tetra = getTetromino(next.pop());
+        prev = tetra;
+        lastLocked = tetra;
+
+        hold = 0, isHeld = 0, heldTetromino = -1;
+        score = 0, level = 1, line = 0, locked = 0;
+        keys = 0, finesseFaults = 0, trackFinesse = 0;
+        gameStarted = 0, isPlaying = 1, isReleased = 1, hardDrop = 0, softDrop = 0;
+        countdown = 3;
+        movementSounds = 0, rotateSounds = 0, hardDropSounds = 0, holdSounds = 0;
+    }
+};
+
+// take the next tetromino from the queue
+void nextTetromino(Game &g)
+{
+    g.tetra = getTetromino(g.next.pop());
+    g.played++;
+    g.keys = 0;
+}
+
+// handle the player's input, the same way the key and mouse events used to be handled in main()
+void applyInput(Game &g, const gameInput &in)
+{
+    if (in.softDrop)
+    {
+        g.delay = g.defaultDelay / 20;
+        g.softDrop = 1;
+    }
+    if (in.hardDrop)
+    {
+        if (g.isReleased)
+            g.hardDrop = 1;
+        g.isReleased = 0;
+    }
+    if (in.hold)
+    {
+        if (!g.isHeld)
+            g.hold = 1;
+        g.isHeld = 1;
+    }
+    if (in.togglePause)
+        g.isPlaying ^= 1;
+    if (in.keyRelease)
+    {
+        g.isReleased = 1;
+        if (in.softDropRelease)
+        {
+            g.delay = g.defaultDelay;
+            g.softDrop = 0;
+        }
+    }
+    if (in.pause)
+        g.isPlaying = 0;
+    if (in.resume)
+    {
+        // if this is the game over screen, do some reset
+        if (isEnd(g.boardStates))
+        {
+            // board reset
+            g.boardStates = board(ROWS, std::vector<int>(COLUMN, 0));
+
+            // states reset
+            g.hold = 0, g.isHeld = 0, g.heldTetromino = -1;
+            g.gameStarted = 0;
+
+            // score, lines, level reset
+            g.score = 0, g.level = 1, g.line = 0;
+            g.keys = 0, g.finesseFaults = 0;
+        }
+        // otherwise, just keep playing
+        g.isPlaying = 1;
+    }
+}
+
+// advance the game by dt seconds
+// the game does not read any clock, callers pass a fixed dt to keep it deterministic
+void updateGame(Game &g, const gameInput &in, const double &dt)
+{
+    g.timer += dt;
+    applyInput(g, in);
+
+    g.prev = g.tetra;
+    if (!g.isPlaying)
+    {
+        g.gameStarted = 0;
+        g.countdown = 3;
+        g.timer = 0;
+        return;
+    }
+
+    // Check whether the game have just been started or not
+    if (!g.gameStarted)
+    {
+        // If the game have just been initiated, obviously we should have some spare seconds for preparation
+        if (g.timer > 1)
+        {
+            g.timer = 0;
+            g.countdown--;
+        }
+        if (g.countdown == 0)
+            g.gameStarted = 1;
+        return;
+    }
+
+    // every new press counts for finesse, a held key only once
+    if (!in.autoRepeat)
+        g.keys += (in.dx != 0) + in.rotate_cw + in.rotate_ccw + in.softDrop;
+
+    // Horizontal movement
+    if (in.dx)
+    {
+        g.movementSounds++;
+        moveHorizontal(g.tetra, g.boardStates, in.dx);
+    }
+
+    // Rotation
+    if (in.rotate_cw)
+    {
+        g.rotateSounds++;
+        rotateTetromino(g.tetra, g.boardStates, 1);
+    }
+
+    if (in.rotate_ccw)
+    {
+        g.rotateSounds++;
+        rotateTetromino(g.tetra, g.boardStates, 0);
+    }
+
+    // hard drop
+    if (g.hardDrop)
+    {
+        g.hardDropSounds++;
+        int dist = dropTetromino(g.tetra, g.prev, g.boardStates);
+        g.score += dist * 2;
+        g.hardDrop = 0;
+    }
+
+    // hold system
+    if (g.hold)
+    {
+        g.holdSounds++;
+        if (g.heldTetromino == -1)
+        {
+            // if there is currently no held tetromino, the current one will be held, and we will get the next one in the queue
+            g.heldTetromino = g.tetra.color;
+            nextTetromino(g);
+        }
+        else
+        {
+            // Otherwise, we will just swap the current and the held tetromino
+            std::swap(g.tetra.color, g.heldTetromino);
+            g.tetra = getTetromino(g.tetra.color);
+            g.keys = 0;
+        }
+        g.hold = 0;
+    }
+
+    // Gravity
+    if (g.timer > g.delay)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            g.tetra.block[i].y++;
+        }
+        g.timer = 0;
+        if (g.softDrop)
+        {
+            g.score++;
+        }
+    }
+
+    // If the tetromino met the "ground", create another
+    if (!isValidPotision(g.tetra, g.boardStates))
+    {
+        g.tetra = g.prev;
+        g.isHeld = 0;
+        g.locked++;
+        g.lastLocked = g.tetra;
+
+        // finesse, judged on the board the tetromino was placed on
+        if (g.trackFinesse)
+        {
+            int needed = finesseCost(g.boardStates, g.tetra);
+            if (needed >= 0 && g.keys > needed)
+                g.finesseFaults++;
+        }
+
+        // Update the game's state
+        lockTetromino(g.tetra, g.boardStates);
+
+        // get a random Tetromino
+        nextTetromino(g);
+
+        int lineCleared = clearLines(g.boardStates);
+
+        g.line += lineCleared;
+        g.score += getScore(lineCleared, g.level);
+        g.isPlaying = !isEnd(g.boardStates);
+
+        // it take 10 line to level up once, therefore
+        g.level = 1 + g.line / 10;
+
+        // level up
+        g.defaultDelay = powd((0.8 - ((g.level - 1) * 0.007)), g.level - 1);
+    }
+}
+
+#endif
@@ -39,6 +39,16 @@ bool checkLines(board &b, const int &row)
     return 1;
 }
 
+// the number of rows from the bottom up to the highest occupied cell
+int stackHeight(const board &b)
+{
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            if (b[i][j])
+                return ROWS - i;
+    return 0;
+}
+
 bool isInside(const point &pos, const point &upperLeft, const point &lowerRight)
 {
     return ((pos.x >= upperLeft.x) &&
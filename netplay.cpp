@@ -0,0 +1,118 @@
+/*
+    Netplay test: two rollback peers playing versus over UDP on this machine
+    Each peer is played by a bot pressing random keys, the link between them can be made slow and lossy
+
+    Usage: netplay [ticks] [delay] [loss]
+    - ticks: how long the bots play (default: 3600, a minute of game)
+    - delay: extra latency of every packet, in ticks (default: 4)
+    - loss: percentage of packets dropped (default: 5)
+
+    At the end, both peers must have exactly the same game
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "rollback.h"
+
+// a random key, most ticks nothing is pressed
+gameInput randomInput(std::mt19937 &rng)
+{
+    gameInput in;
+    switch (rng() % 12)
+    {
+    case 0:
+        in.dx = -1;
+        break;
+    case 1:
+        in.dx = 1;
+        break;
+    case 2:
+        in.rotate_cw = 1;
+        break;
+    case 3:
+        in.rotate_ccw = 1;
+        break;
+    case 4:
+        in.hardDrop = 1;
+        break;
+    case 5:
+        in.keyRelease = 1, in.softDropRelease = 1;
+        break;
+    case 6:
+        in.hold = 1;
+        break;
+    }
+    return in;
+}
+
+// the state of the peer before tick t, t must be known by the peer
+const versus &stateAt(const rollbackPeer &r, const int &t)
+{
+    if (t == r.tick)
+        return r.state;
+    return r.snapshots[t % ROLLBACK_HISTORY];
+}
+
+int main(int argc, char **argv)
+{
+    int ticks = argc > 1 ? atoi(argv[1]) : 3600;
+    int delay = argc > 2 ? atoi(argv[2]) : 4;
+    int loss = argc > 3 ? atoi(argv[3]) : 5;
+
+    unsigned long long seed = std::time(NULL);
+    rollbackPeer *peers[2] = {new rollbackPeer(0, seed), new rollbackPeer(1, seed)};
+    if (!peers[0]->link.open(7001, "127.0.0.1", 7002) || !peers[1]->link.open(7002, "127.0.0.1", 7001))
+    {
+        perror("udp");
+        return 1;
+    }
+
+    std::mt19937 rng[2] = {std::mt19937(1), std::mt19937(2)};
+    gameInput next[2];
+    for (int p = 0; p < 2; p++)
+    {
+        peers[p]->link.delay = delay, peers[p]->link.loss = loss;
+        peers[p]->link.rng.seed(p + 10);
+        next[p] = randomInput(rng[p]);
+    }
+
+    // play, then let the last inputs arrive
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int frames = 0;
+    while (std::min(peers[0]->tick, peers[1]->tick) < ticks || frames < ticks + 20 * (delay + MAX_ROLLBACK))
+    {
+        frames++;
+        for (int p = 0; p < 2; p++)
+        {
+            bool playing = peers[p]->tick < ticks;
+            if (advance(*peers[p], playing ? next[p] : gameInput()) && playing)
+                next[p] = randomInput(rng[p]);
+        }
+        // give the packets the time to go through the loopback
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        if (frames > 100 * (ticks + 1000))
+            break;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (int p = 0; p < 2; p++)
+    {
+        synchronize(*peers[p]);
+        rollbackPeer &r = *peers[p];
+        std::cout << "peer " << p << ": " << r.tick << " ticks, " << r.rollbacks << " rollbacks, "
+                  << r.resimulated << " ticks resimulated, " << r.stalls << " stalls, longest rollback "
+                  << std::fixed << std::setprecision(3) << r.maxResimulation * 1000 << " ms\n";
+    }
+
+    int t = std::min(std::min(peers[0]->tick, peers[1]->tick), std::min(peers[0]->remoteConfirmed, peers[1]->remoteConfirmed));
+    bool same = 1;
+    for (int p = 0; p < 2; p++)
+        same &= gameChecksum(stateAt(*peers[0], t).games[p]) == gameChecksum(stateAt(*peers[1], t).games[p]);
+    std::cout << frames << " frames in " << std::setprecision(2) << elapsed << " s, compared at tick " << t << ": "
+              << (same ? "in sync" : "DESYNC") << "\n";
+
+    delete peers[0];
+    delete peers[1];
+    return same ? 0 : 1;
+}
@@ -25,6 +25,181 @@ int clearLines(board &b)
     return rowCleared;
 }
 
+// put the tetromino into the game's state
+void lockTetromino(const Tetromino &t, board &b)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        b[t.block[i].y][t.block[i].x] = t.color + 1;
+    }
+}
+
+// move the tetromino horizontally, the move is undone if the new potision is invalid
+void moveHorizontal(Tetromino &t, const board &b, const int &dx)
+{
+    Tetromino backup = t;
+    for (int i = 0; i < 4; i++)
+    {
+        t.block[i].x += dx;
+    }
+    if (!isValidPotision(t, b))
+        t = backup;
+}
+
+// rotate the tetromino around its second block, then try to kick it off the walls
+// the result can still be invalid, in which case the caller should fall back to the previous potision
+void rotateTetromino(Tetromino &t, const board &b, const bool &clockwise)
+{
+    /*
+        Consider a clockwise rotation with angle T, original point (x,y), new point(x',y')
+        x' = xcos(T) - ysin(T)
+        y' = xsin(T) + ycos(T)
+        As T = 90deg => sin(T) = 1, cos(T) = 0
+        => x' = -y, y' = x
+        Now, consider a new coordinate that the origin is (a,b)
+        xn = x - a, yn = y - b
+        Thus: xn' = - y + b, yn' = x - a
+
+        Rotating 90deg counter-clockwise is basically rotating -90deg clockwise
+        => sin(T) = -1, cos(T) = 0;
+        => x' = y, y' = -x;
+        Thus: xn' = y - b, yn' = - x + a
+    */
+
+    point origin = t.block[1];
+    for (int i = 0; i < 4; i++)
+    {
+        // new coordinate in the new system
+        int xn, yn;
+        if (clockwise)
+        {
+            xn = -t.block[i].y + origin.y;
+            yn = t.block[i].x - origin.x;
+        }
+        else
+        {
+            xn = t.block[i].y - origin.y;
+            yn = -t.block[i].x + origin.x;
+        }
+
+        // new coordinate in the original system
+        t.block[i].x = origin.x + xn;
+        t.block[i].y = origin.y + yn;
+    }
+
+    // wall kick
+    if (!isValidPotision(t, b))
+    {
+        // check how the rotation change the tetromino's alignment
+        int newLeftMost = COLUMN, newUpMost = ROWS, newRightMost = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            newLeftMost = std::min(newLeftMost, t.block[i].x);
+            newRightMost = std::max(newRightMost, t.block[i].x);
+            newUpMost = std::min(newUpMost, t.block[i].y);
+        }
+
+        if (newUpMost < 0)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                t.block[i].y -= newUpMost;
+            }
+        }
+
+        bool toLeft = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            if (newLeftMost == t.block[i].x)
+            {
+                if (!isValidPoint(t.block[i], b))
+                    toLeft = 1;
+            }
+        }
+
+        if (toLeft)
+        {
+            int move = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                point p = point(t.block[i].y, t.block[i].x);
+                if (!isValidPoint(t.block[i], b))
+                {
+                    move = std::max(move, p.y - newLeftMost + 1);
+                }
+            }
+
+            for (int i = 0; i < 4; i++)
+            {
+                t.block[i].x += move;
+            }
+        }
+        else
+        {
+            int move = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                point p = point(t.block[i].y, t.block[i].x);
+                if (!isValidPoint(t.block[i], b))
+                {
+                    move = std::max(move, newRightMost - p.y + 1);
+                }
+            }
+            for (int i = 0; i < 4; i++)
+            {
+                t.block[i].x -= move;
+            }
+        }
+    }
+}
+
+// The tetromino is instantly slam to the ground
+// We do that by moving it down vertically with no delay, until it hit the ground
+// t ends up in the first invalid potision, prev in the last valid one; return the distance
+int dropTetromino(Tetromino &t, Tetromino &prev, const board &b)
+{
+    int dist = 0;
+    while (isValidPotision(t, b))
+    {
+        prev = t;
+        for (int i = 0; i < 4; i++)
+        {
+            t.block[i].y++;
+        }
+        dist++;
+    }
+    return dist;
+}
+
+// Garbage lines sent by the opponent in versus, they have a color of their own
+const int GARBAGE = 7;
+
+// push the stack up and fill the bottom rows, each with one hole at the same column
+// return 0 if blocks were pushed out of the board
+bool addGarbage(board &b, const int &rows, const int &hole)
+{
+    bool fits = 1;
+    for (int i = 0; i < rows && i < ROWS; i++)
+    {
+        for (int j = 0; j < COLUMN; j++)
+        {
+            if (b[i][j])
+                fits = 0;
+        }
+    }
+    for (int i = 0; i < ROWS; i++)
+    {
+        if (i + rows < ROWS)
+            b[i] = b[i + rows];
+        else
+        {
+            for (int j = 0; j < COLUMN; j++)
+                b[i][j] = (j == hole) ? 0 : GARBAGE + 1;
+        }
+    }
+    return fits;
+}
+
 // convert integer into string
 std::string intToString(int x)
 {
@@ -64,12 +239,6 @@ sf::Text TextSetup(const sf::Font &font, const int &size, const sf::Color &color
     return t;
 }
 
-// Just to random
-int myrandom(int i)
-{
-    return std::rand() % i;
-}
-
 // exponent
 double powd(double x, int y)
 {
@@ -0,0 +1,161 @@
+/*
+    Perft: count every distinct position reachable after 1..N pieces
+    Like the perft of chess engines, it is a correctness check for the movement and collision code,
+    and a benchmark of how fast the engine can generate placements
+
+    Usage: perft [pieces] [depth] [board file]
+    - pieces: the fixed piece sequence, using the letters I O S Z L J T (default: IOSZLJT)
+    - depth: how many pieces to play (default: 3)
+    - board file: 20 lines of 10 characters, '.' is an empty cell, anything else is filled (default: empty board)
+
+    A position is the board, the potision in the sequence and the held piece
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "solver.h"
+
+struct position
+{
+    board b;
+    int index, hold;
+};
+
+struct perftResult
+{
+    long long positions, placements;
+    double seconds;
+};
+
+// play one more piece from every position of the frontier, using "threadCount" threads
+perftResult expand(std::vector<position> &frontier, const std::vector<int> &queue, const bool &withHold, const int &threadCount)
+{
+    std::vector<std::vector<position>> children(threadCount);
+    std::vector<std::unordered_set<pcKey, pcKeyHash>> seen(threadCount);
+    std::vector<long long> placements(threadCount, 0);
+    std::atomic<size_t> next(0);
+
+    auto worker = [&](int id)
+    {
+        size_t p;
+        while ((p = next++) < frontier.size())
+        {
+            const position &pos = frontier[p];
+            std::vector<pcChoice> choices = getChoices(queue, pos.index, pos.hold, withHold);
+            for (size_t i = 0; i < choices.size(); i++)
+            {
+                std::vector<Tetromino> result = getPlacements(pos.b, choices[i].piece);
+                placements[id] += result.size();
+                for (size_t j = 0; j < result.size(); j++)
+                {
+                    position child;
+                    child.b = pos.b;
+                    lockTetromino(result[j], child.b);
+                    clearLines(child.b);
+                    child.index = choices[i].next;
+                    child.hold = choices[i].hold;
+                    if (seen[id].insert(getKey(child.b, child.index, child.hold, 0)).second)
+                        children[id].push_back(child);
+                }
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++)
+        threads.push_back(std::thread(worker, i));
+    worker(0);
+    for (size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    // merge what the threads found, the same position can be reached from different threads
+    std::unordered_set<pcKey, pcKeyHash> all;
+    std::vector<position> merged;
+    perftResult r = {0, 0, 0};
+    for (int id = 0; id < threadCount; id++)
+    {
+        r.placements += placements[id];
+        for (size_t i = 0; i < children[id].size(); i++)
+        {
+            const position &c = children[id][i];
+            if (all.insert(getKey(c.b, c.index, c.hold, 0)).second)
+                merged.push_back(c);
+        }
+    }
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.positions = merged.size();
+
+    // the game is over for positions with blocks on the top row, they are counted but not played further
+    frontier.clear();
+    for (size_t i = 0; i < merged.size(); i++)
+        if (!isEnd(merged[i].b))
+            frontier.push_back(merged[i]);
+    return r;
+}
+
+void perft(const board &start, const std::vector<int> &queue, const int &depth, const bool &withHold, const int &threadCount)
+{
+    std::cout << (withHold ? "with hold" : "without hold") << ", " << threadCount << " thread(s)\n";
+    std::cout << std::setw(6) << "depth" << std::setw(14) << "positions" << std::setw(14) << "placements"
+              << std::setw(12) << "time (ms)" << std::setw(16) << "nodes/sec" << "\n";
+
+    std::vector<position> frontier(1, {start, 0, -1});
+    long long totalPlacements = 0;
+    double totalSeconds = 0;
+    for (int d = 1; d <= depth && !frontier.empty(); d++)
+    {
+        perftResult r = expand(frontier, queue, withHold, threadCount);
+        totalPlacements += r.placements;
+        totalSeconds += r.seconds;
+        std::cout << std::setw(6) << d << std::setw(14) << r.positions << std::setw(14) << r.placements
+                  << std::setw(12) << std::fixed << std::setprecision(1) << r.seconds * 1000
+                  << std::setw(16) << std::setprecision(0) << r.placements / std::max(r.seconds, 1e-9) << "\n";
+    }
+    std::cout << "total: " << totalPlacements << " placements, "
+              << std::setprecision(0) << totalPlacements / std::max(totalSeconds, 1e-9) << " nodes/sec\n\n";
+}
+
+int main(int argc, char **argv)
+{
+    const std::string names = "IOSZLJT"; // same order as getTetromino()
+    std::string pieces = argc > 1 ? argv[1] : names;
+    int depth = argc > 2 ? atoi(argv[2]) : 3;
+
+    std::vector<int> queue;
+    for (size_t i = 0; i < pieces.size(); i++)
+    {
+        size_t type = names.find(toupper(pieces[i]));
+        if (type == std::string::npos)
+        {
+            std::cerr << "unknown piece: " << pieces[i] << "\n";
+            return 1;
+        }
+        queue.push_back(type);
+    }
+
+    board start(ROWS, std::vector<int>(COLUMN, 0));
+    if (argc > 3)
+    {
+        std::ifstream in(argv[3]);
+        if (!in)
+        {
+            std::cerr << "cannot open " << argv[3] << "\n";
+            return 1;
+        }
+        std::string row;
+        for (int i = 0; i < ROWS && std::getline(in, row); i++)
+            for (int j = 0; j < COLUMN && j < (int)row.size(); j++)
+                start[i][j] = row[j] != '.';
+    }
+
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (int withHold = 0; withHold < 2; withHold++)
+    {
+        perft(start, queue, depth, withHold, 1);
+        if (threadCount > 1)
+            perft(start, queue, depth, withHold, threadCount);
+    }
+    return 0;
+}
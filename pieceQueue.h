@@ -0,0 +1,65 @@
+#ifndef PIECEQUEUE_H
+#define PIECEQUEUE_H
+
+#include <bits/stdc++.h>
+
+// Deterministic random numbers in [0, n): a game only depends on its seed and its inputs
+// so two machines given the same seed and inputs play exactly the same game
+int nextRandom(unsigned long long &seed, const int &n)
+{
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (seed >> 33) % n;
+}
+
+/*
+    The upcoming tetrominos
+    Tetrominos will be delivered in "patch" of 7 types, each types will only have 1 tetromino
+    The order of appearing will be represented by a random permutation of said types, like taking them from a bag
+    The queue is a ring buffer always holding at least LOOKAHEAD tetrominos, a whole new bag is shuffled in
+    whenever it runs low, so looking ahead never copies or reshuffles anything
+*/
+const int LOOKAHEAD = 14;
+const int QUEUE_CAPACITY = 32; // power of 2, more than LOOKAHEAD + 7
+
+struct pieceQueue
+{
+    int pieces[QUEUE_CAPACITY];
+    int head, count;
+    unsigned long long seed; // state of the random generator of the bags
+
+    pieceQueue(const unsigned long long &_seed = 0)
+    {
+        head = 0, count = 0, seed = _seed;
+        refill();
+    }
+
+    void refill()
+    {
+        while (count < LOOKAHEAD)
+        {
+            int bag[7] = {0, 1, 2, 3, 4, 5, 6};
+            for (int i = 6; i > 0; i--)
+                std::swap(bag[i], bag[nextRandom(seed, i + 1)]);
+            for (int i = 0; i < 7; i++)
+                pieces[(head + count++) & (QUEUE_CAPACITY - 1)] = bag[i];
+        }
+    }
+
+    // the n-th upcoming tetromino, 0 is the next one; n must be less than LOOKAHEAD
+    int peek(const int &n) const
+    {
+        return pieces[(head + n) & (QUEUE_CAPACITY - 1)];
+    }
+
+    // take the next tetromino out of the queue
+    int pop()
+    {
+        int piece = pieces[head];
+        head = (head + 1) & (QUEUE_CAPACITY - 1);
+        count--;
+        refill();
+        return piece;
+    }
+};
+
+#endif
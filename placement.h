@@ -0,0 +1,140 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "operation.h"
+
+/*
+    Every input the player can give to a falling tetromino
+    Each input is handled exactly like one frame of the game loop in main():
+    the tetromino is moved, and if it ends up somewhere invalid, it is put back and locked
+*/
+enum
+{
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    MOVE_CW,
+    MOVE_CCW,
+    MOVE_DOWN,
+    MOVE_HARD_DROP,
+    MOVE_COUNT
+};
+
+// apply an input to the tetromino, return 1 if the tetromino is locked afterward
+bool applyMove(Tetromino &t, const board &b, const int &move)
+{
+    Tetromino prev = t;
+    switch (move)
+    {
+    case MOVE_LEFT:
+        moveHorizontal(t, b, -1);
+        break;
+    case MOVE_RIGHT:
+        moveHorizontal(t, b, 1);
+        break;
+    case MOVE_CW:
+        rotateTetromino(t, b, 1);
+        break;
+    case MOVE_CCW:
+        rotateTetromino(t, b, 0);
+        break;
+    case MOVE_DOWN:
+        for (int i = 0; i < 4; i++)
+            t.block[i].y++;
+        break;
+    case MOVE_HARD_DROP:
+        dropTetromino(t, prev, b);
+        break;
+    }
+    if (!isValidPotision(t, b))
+    {
+        t = prev;
+        return 1;
+    }
+    return 0;
+}
+
+// the shape of a tetromino relative to its second block, the block it rotates around
+// rotations and kicks keep the order of the blocks, so a tetromino only ever has 4 different shapes
+long long shapeKey(const Tetromino &t)
+{
+    long long key = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        key = key * 64 + (t.block[i].x - t.block[1].x + 4);
+        key = key * 64 + (t.block[i].y - t.block[1].y + 4);
+    }
+    return key;
+}
+
+// two locked tetrominos are the same placement if they cover the same cells
+unsigned int cellsKey(const Tetromino &t)
+{
+    int cell[4];
+    for (int i = 0; i < 4; i++)
+        cell[i] = t.block[i].y * COLUMN + t.block[i].x;
+    std::sort(cell, cell + 4);
+    unsigned int key = 0;
+    for (int i = 0; i < 4; i++)
+        key |= (unsigned int)cell[i] << (8 * i);
+    return key;
+}
+
+// find every distinct potision a new tetromino of this type can be locked at
+// a breadth first search over the inputs above, starting from the spawn potision
+// hard drop is left out, it always ends where moving down again and again would
+std::vector<Tetromino> getPlacements(const board &b, const int &type)
+{
+    std::vector<Tetromino> result;
+    Tetromino spawn = getTetromino(type);
+    if (!isValidPotision(spawn, b))
+        return result;
+
+    // a state is (shape, potision of the second block), small enough for plain arrays
+    long long shapes[4];
+    int shapeCount = 0;
+    bool visited[4][ROWS * COLUMN] = {};
+    std::vector<unsigned int> locked;
+    std::vector<Tetromino> queue;
+    queue.reserve(4 * ROWS * COLUMN);
+
+    auto visit = [&](const Tetromino &t)
+    {
+        long long shape = shapeKey(t);
+        int s = 0;
+        while (s < shapeCount && shapes[s] != shape)
+            s++;
+        if (s == shapeCount)
+            shapes[shapeCount++] = shape;
+        bool &seen = visited[s][t.block[1].y * COLUMN + t.block[1].x];
+        if (seen)
+            return;
+        seen = 1;
+        queue.push_back(t);
+    };
+
+    visit(spawn);
+    for (size_t head = 0; head < queue.size(); head++)
+    {
+        for (int move = 0; move < MOVE_HARD_DROP; move++)
+        {
+            Tetromino t = queue[head];
+            if (applyMove(t, b, move))
+            {
+                unsigned int key = cellsKey(t);
+                if (std::find(locked.begin(), locked.end(), key) == locked.end())
+                {
+                    locked.push_back(key);
+                    result.push_back(t);
+                }
+            }
+            else
+                visit(t);
+        }
+    }
+    return result;
+}
+
+#endif
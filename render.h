@@ -0,0 +1,239 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+#include "solver.h"
+
+const int BLOCK_SIZE = 25;
+
+// Number of upcoming tetrominos shown next to the hold section
+const int PREVIEW = 5;
+
+// Get the texture ready
+struct gameAssets
+{
+    sf::Texture texture, backgroundTextures, pauseScreenTextures, helpScreenTextures, endScreenTextures;
+    sf::Texture musicButtonTextures, soundEffectButtonTextures;
+    sf::Font font;
+
+    gameAssets()
+    {
+        texture.loadFromFile("textures/Tetromino.png");
+        backgroundTextures.loadFromFile("textures/Background.jpg");
+        pauseScreenTextures.loadFromFile("textures/Pause.png");
+        helpScreenTextures.loadFromFile("textures/Help.png");
+        endScreenTextures.loadFromFile("textures/GameOver.png");
+        musicButtonTextures.loadFromFile("textures/speaker.png");
+        soundEffectButtonTextures.loadFromFile("textures/musicnote.png");
+        font.loadFromFile("fonts/Retro Gaming.ttf");
+    }
+};
+
+// what is on the screen apart from the game itself
+struct screenState
+{
+    bool isBGM, isSFX, isHelp;
+    const pcSolution *hint; // perfect clear hint for the current piece, nullptr if there is none
+    screenState()
+    {
+        isBGM = 1, isSFX = 1, isHelp = 0;
+        hint = nullptr;
+    }
+};
+
+// draw one block of the given color at (x, y) pixels
+void drawBlock(sf::RenderTarget &window, sf::Sprite &sprite, const int &color, const float &x, const float &y)
+{
+    sprite.setPosition(x, y);
+    if (color == GARBAGE)
+    {
+        // garbage has no texture of its own, it is a gray I block
+        sf::Color tint = sprite.getColor();
+        sprite.setTextureRect(sf::IntRect(0, 0, BLOCK_SIZE, BLOCK_SIZE));
+        sprite.setColor(sf::Color(110, 110, 110, tint.a));
+        window.draw(sprite);
+        sprite.setColor(tint);
+        return;
+    }
+    sprite.setTextureRect(sf::IntRect(color * BLOCK_SIZE, 0, BLOCK_SIZE, BLOCK_SIZE));
+    window.draw(sprite);
+}
+
+// draw a whole tetromino of this type scaled down, centered on centerX, its top at y
+void drawPiece(sf::RenderTarget &window, sf::Sprite &sprite, const int &type, const float &centerX, const float &y, const float &scale)
+{
+    Tetromino t = getTetromino(type);
+    int left = COLUMN, right = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        left = std::min(left, t.block[i].x);
+        right = std::max(right, t.block[i].x);
+    }
+    float size = BLOCK_SIZE * scale;
+    float x = centerX - (right - left + 1) * size / 2;
+    sprite.setScale(scale, scale);
+    for (int i = 0; i < 4; i++)
+        drawBlock(window, sprite, type, x + (t.block[i].x - left) * size, y + t.block[i].y * size);
+    sprite.setScale(1, 1);
+}
+
+// the "next" section: the first upcoming tetromino in full size, the others smaller below it
+void drawPreview(sf::RenderTarget &window, sf::Sprite &sprite, const Game &g, const gameAssets &a)
+{
+    sf::RectangleShape panel(sf::Vector2f(110, 290));
+    panel.setFillColor(sf::Color(128, 128, 128));
+    panel.setOutlineColor(sf::Color(200, 200, 200));
+    panel.setOutlineThickness(4);
+    panel.move(520, 55);
+    window.draw(panel);
+
+    sf::Text title = TextSetup(a.font, 20, sf::Color::Black, "NEXT");
+    title.move(548, 58);
+    window.draw(title);
+
+    drawPiece(window, sprite, g.next.peek(0), 575, 95, 1);
+    for (int i = 1; i < PREVIEW; i++)
+        drawPiece(window, sprite, g.next.peek(i), 575, 110 + i * 45, 0.6);
+}
+
+// draw the whole screen for this state of the game
+void drawGame(sf::RenderTarget &window, const Game &g, const gameAssets &a, const screenState &s)
+{
+    sf::Sprite sprite, background;
+    sprite.setTexture(a.texture);
+    background.setTexture(a.backgroundTextures);
+
+    window.clear(sf::Color::White);
+
+    // Draw the background
+    window.draw(background);
+
+    // Game over
+    if (isEnd(g.boardStates))
+    {
+        // Draw the end
+        sf::Sprite endScreen;
+        endScreen.setTexture(a.endScreenTextures);
+        endScreen.move(146, 96);
+        window.draw(endScreen);
+        return;
+    }
+
+    // Draw the score
+    std::string scoreString = intToStringFilled(g.score);
+    sf::Text scoreText = TextSetup(a.font, 25, sf::Color::Black, scoreString);
+    scoreText.move(372, 310);
+    window.draw(scoreText);
+
+    // Draw the level
+    std::string levelString = intToStringFilled(g.level);
+    sf::Text levelText = TextSetup(a.font, 25, sf::Color::Blue, levelString);
+    levelText.move(372, 390);
+    window.draw(levelText);
+
+    // Draw the line
+    std::string lineString = intToStringFilled(g.line);
+    sf::Text lineText = TextSetup(a.font, 25, sf::Color::Green, lineString);
+    lineText.move(372, 470);
+    window.draw(lineText);
+
+    // Draw the finesse faults, under the next section
+    sf::Text faultTitle = TextSetup(a.font, 15, sf::Color::Black, "FAULTS");
+    faultTitle.move(535, 360);
+    window.draw(faultTitle);
+    sf::Text faultText = TextSetup(a.font, 25, sf::Color::Red, intToString(g.finesseFaults));
+    faultText.move(545, 380);
+    window.draw(faultText);
+
+    // Draw the buttons
+
+    sf::Sprite musicButton;
+    musicButton.setTexture(a.musicButtonTextures);
+    musicButton.move(375, 200);
+    if (!s.isBGM) musicButton.setColor(sf::Color::Red);
+    window.draw(musicButton);
+
+    sf::Sprite soundEffectButton;
+    soundEffectButton.setTexture(a.soundEffectButtonTextures);
+    soundEffectButton.move(440, 200);
+    if (!s.isSFX) soundEffectButton.setColor(sf::Color::Red);
+    window.draw(soundEffectButton);
+
+    // Draw the countdown
+    if (g.countdown && g.isPlaying)
+    {
+        std::string cdString = intToString(g.countdown);
+        sf::Text cdText = TextSetup(a.font, 150, sf::Color::Red, cdString);
+        cdText.move(210, 200);
+        window.draw(cdText);
+    }
+
+    // Draw the paused
+    if (!g.isPlaying)
+    {
+        sf::Sprite pauseScreen;
+        pauseScreen.setTexture(a.pauseScreenTextures);
+        pauseScreen.move(146, 96);
+        window.draw(pauseScreen);
+        if (s.isHelp)
+        {
+            sf::Sprite helpScreen;
+            helpScreen.setTexture(a.helpScreenTextures);
+            helpScreen.move(53, 134);
+            window.draw(helpScreen);
+        }
+    }
+
+    if (!g.gameStarted)
+        return;
+
+    // Draw the current blocks
+    for (int i = 0; i < ROWS; i++)
+    {
+        for (int j = 0; j < COLUMN; j++)
+        {
+            if (g.boardStates[i][j])
+                drawBlock(window, sprite, g.boardStates[i][j] - 1, 50 + j * BLOCK_SIZE, 50 + i * BLOCK_SIZE);
+        }
+    }
+
+    // Draw the perfect clear hint, up to its first line clear
+    if (s.hint && s.hint->found)
+    {
+        sprite.setColor(sf::Color(255, 255, 255, 90));
+        for (size_t k = 0; k < s.hint->steps.size(); k++)
+        {
+            const Tetromino &ghost = s.hint->steps[k].t;
+            for (int i = 0; i < 4; i++)
+                drawBlock(window, sprite, ghost.color, 50 + ghost.block[i].x * BLOCK_SIZE, 50 + ghost.block[i].y * BLOCK_SIZE);
+            if (s.hint->steps[k].cleared)
+                break;
+        }
+        sprite.setColor(sf::Color::White);
+    }
+
+    // Draw the tetromino in "hold" section
+    if (g.heldTetromino != -1)
+    {
+        Tetromino holded = getTetromino(g.heldTetromino);
+        int x = 317;
+        if (holded.color == 0)
+            x = 330;
+        else if (holded.color == 1)
+            x = 305;
+        for (int i = 0; i < 4; i++)
+            drawBlock(window, sprite, holded.color, x + holded.block[i].x * BLOCK_SIZE, 100 + holded.block[i].y * BLOCK_SIZE);
+    }
+
+    // Draw the upcoming tetrominos
+    drawPreview(window, sprite, g, a);
+
+    // Draw the falling blocks
+    for (int i = 0; i < 4; i++)
+        drawBlock(window, sprite, g.tetra.color, 50 + g.tetra.block[i].x * BLOCK_SIZE, 50 + g.tetra.block[i].y * BLOCK_SIZE);
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+
+/*
+    Replays: games are deterministic, so the seed and the input of every tick are enough to play one again
+    A replay file holds any number of games one after the other: "KTREPLAY", then for each game
+    the seed (uint64), the number of ticks (uint32) and one 16 bits input per tick, little endian
+*/
+
+const double REPLAY_TICK = 1.0 / 60;
+
+// an input fits in 16 bits, on the wire and in replays
+unsigned short encodeInput(const gameInput &in)
+{
+    return (in.dx + 1) | in.rotate_cw << 2 | in.rotate_ccw << 3 | in.softDrop << 4 | in.softDropRelease << 5 |
+           in.hardDrop << 6 | in.hold << 7 | in.keyRelease << 8 | in.autoRepeat << 9 |
+           in.togglePause << 10 | in.pause << 11 | in.resume << 12;
+}
+
+gameInput decodeInput(const unsigned short &code)
+{
+    gameInput in;
+    in.dx = (code & 3) - 1;
+    in.rotate_cw = code >> 2 & 1, in.rotate_ccw = code >> 3 & 1;
+    in.softDrop = code >> 4 & 1, in.softDropRelease = code >> 5 & 1;
+    in.hardDrop = code >> 6 & 1, in.hold = code >> 7 & 1, in.keyRelease = code >> 8 & 1;
+    in.autoRepeat = code >> 9 & 1;
+    in.togglePause = code >> 10 & 1, in.pause = code >> 11 & 1, in.resume = code >> 12 & 1;
+    return in;
+}
+
+const unsigned short NO_INPUT = 1; // encodeInput(gameInput())
+
+struct replay
+{
+    unsigned long long seed;
+    std::vector<unsigned short> inputs;
+    replay(const unsigned long long &_seed = 0)
+    {
+        seed = _seed;
+    }
+};
+
+// write the games at the end of the file, the file is created if needed
+bool saveReplays(const std::string &file, const std::vector<replay> &games)
+{
+    FILE *f = fopen(file.c_str(), "ab");
+    if (!f)
+        return 0;
+    if (ftell(f) == 0)
+        fwrite("KTREPLAY", 1, 8, f);
+    for (size_t i = 0; i < games.size(); i++)
+    {
+        uint64_t seed = games[i].seed;
+        uint32_t ticks = games[i].inputs.size();
+        fwrite(&seed, sizeof(seed), 1, f);
+        fwrite(&ticks, sizeof(ticks), 1, f);
+        fwrite(games[i].inputs.data(), sizeof(unsigned short), ticks, f);
+    }
+    return fclose(f) == 0;
+}
+
+// read every game of the file, return 0 if it is not a replay file or is cut short
+bool loadReplays(const std::string &file, std::vector<replay> &games)
+{
+    FILE *f = fopen(file.c_str(), "rb");
+    if (!f)
+        return 0;
+    char magic[8];
+    bool ok = fread(magic, 1, 8, f) == 8 && !memcmp(magic, "KTREPLAY", 8);
+    uint64_t seed;
+    uint32_t ticks;
+    while (ok && fread(&seed, sizeof(seed), 1, f) == 1)
+    {
+        games.push_back(replay(seed));
+        ok = fread(&ticks, sizeof(ticks), 1, f) == 1;
+        if (ok)
+        {
+            games.back().inputs.resize(ticks);
+            ok = fread(games.back().inputs.data(), sizeof(unsigned short), ticks, f) == ticks;
+        }
+    }
+    fclose(f);
+    return ok;
+}
+
+// play a replay again, onTick(game, tick) is called after every tick
+template <typename F>
+Game playReplay(const replay &r, F onTick)
+{
+    Game g(r.seed);
+    for (size_t t = 0; t < r.inputs.size(); t++)
+    {
+        updateGame(g, decodeInput(r.inputs[t]), REPLAY_TICK);
+        onTick(g, t);
+    }
+    return g;
+}
+
+#endif
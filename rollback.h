@@ -0,0 +1,238 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "replay.h"
+#include "versus.h"
+
+/*
+    Rollback netcode for versus over UDP (Linux only)
+    Both peers simulate the same versus at the same fixed tick, each one only knows its own inputs in time:
+    - the remote input of a tick that has not arrived yet is predicted (nothing pressed)
+    - the state before every tick is kept, so when the real remote input arrives and differs from the prediction,
+      the game is restored to the first wrong tick and simulated again up to now, within the same frame
+    - a peer never runs more than MAX_ROLLBACK ticks ahead of the last remote input it knows, it waits instead
+    Games are deterministic (seeded bags, fixed dt), so both peers end up with the same state
+*/
+
+const double ROLLBACK_TICK = 1.0 / 60;
+const int ROLLBACK_HISTORY = 64; // ticks of snapshots and inputs kept
+const int MAX_ROLLBACK = 12;
+
+// hash of everything that matters in a game, to check that both peers agree
+unsigned long long gameChecksum(const Game &g)
+{
+    unsigned long long h = 1469598103934665603ULL;
+    auto mix = [&](const long long &x)
+    {
+        h = (h ^ (unsigned long long)x) * 1099511628211ULL;
+    };
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            mix(g.boardStates[i][j]);
+    for (int i = 0; i < 4; i++)
+        mix(g.tetra.block[i].x), mix(g.tetra.block[i].y);
+    mix(g.tetra.color), mix(g.heldTetromino), mix(g.played), mix(g.seed);
+    mix(g.score), mix(g.line), mix(g.locked), mix(g.isPlaying);
+    return h;
+}
+
+/*
+    UDP socket to the other peer
+    For local testing, outgoing packets can be held back for some ticks and randomly dropped
+*/
+struct udpLink
+{
+    int fd;
+    sockaddr_in peer;
+    int delay, loss; // ticks of extra latency, percentage of dropped packets
+    std::deque<std::pair<int, std::string>> outgoing; // (tick to send at, packet)
+    std::mt19937 rng;
+
+    udpLink()
+    {
+        fd = -1, delay = 0, loss = 0;
+    }
+
+    bool open(const int &localPort, const std::string &peerHost, const int &peerPort)
+    {
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in local = {};
+        local.sin_family = AF_INET;
+        local.sin_addr.s_addr = htonl(INADDR_ANY);
+        local.sin_port = htons(localPort);
+        if (fd == -1 || bind(fd, (sockaddr *)&local, sizeof(local)) == -1)
+            return 0;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        peer = sockaddr_in();
+        peer.sin_family = AF_INET;
+        peer.sin_port = htons(peerPort);
+        return inet_pton(AF_INET, peerHost.c_str(), &peer.sin_addr) == 1;
+    }
+
+    void send(const std::string &packet, const int &now)
+    {
+        if (loss && (int)(rng() % 100) < loss)
+            return;
+        outgoing.push_back(std::make_pair(now + delay, packet));
+        flush(now);
+    }
+
+    void flush(const int &now)
+    {
+        while (!outgoing.empty() && outgoing.front().first <= now)
+        {
+            const std::string &packet = outgoing.front().second;
+            sendto(fd, packet.data(), packet.size(), 0, (sockaddr *)&peer, sizeof(peer));
+            outgoing.pop_front();
+        }
+    }
+
+    // return the size of the packet, or -1 if there is none
+    int receive(char *buffer, const int &size)
+    {
+        return recv(fd, buffer, size, 0);
+    }
+
+    ~udpLink()
+    {
+        if (fd != -1)
+            close(fd);
+    }
+};
+
+struct rollbackPeer
+{
+    int local, remote;
+    versus state;
+    versus snapshots[ROLLBACK_HISTORY];              // state before each tick
+    unsigned short inputs[ROLLBACK_HISTORY][2];      // inputs of each tick, the remote ones may be predictions
+    int tick;                                        // next tick to simulate
+    int remoteConfirmed;                             // every remote input before this tick is known
+    int localAcked;                                  // the other peer has every local input before this tick
+    int rollbackFrom;                                // first tick simulated with a wrong prediction, -1 if none
+    int clock;                                       // frames elapsed, ticks may stall but the clock does not
+    udpLink link;
+
+    // statistics
+    long long rollbacks, resimulated, stalls;
+    double maxResimulation; // longest restore and resimulation, in seconds
+
+    rollbackPeer(const int &_local, const unsigned long long &seed) : state(2, seed)
+    {
+        local = _local, remote = 1 - _local;
+        tick = 0, remoteConfirmed = 0, localAcked = 0, rollbackFrom = -1, clock = 0;
+        for (int i = 0; i < ROLLBACK_HISTORY; i++)
+            inputs[i][0] = inputs[i][1] = NO_INPUT;
+        rollbacks = 0, resimulated = 0, stalls = 0, maxResimulation = 0;
+    }
+};
+
+void simulateTick(rollbackPeer &r, const int &t)
+{
+    for (int p = 0; p < 2; p++)
+    {
+        updateGame(r.state.games[p], decodeInput(r.inputs[t % ROLLBACK_HISTORY][p]), ROLLBACK_TICK);
+        settleVersus(r.state, p);
+    }
+}
+
+/*
+    Packet: tick of the first input, number of inputs, ack (every input of the other peer before this tick is known),
+    then the local inputs from the first one the other peer has not acknowledged
+*/
+void sendInputs(rollbackPeer &r)
+{
+    // the other peer is never more than 2 * MAX_ROLLBACK ticks behind, older inputs are not needed
+    int first = std::max(r.localAcked, r.tick - 2 * MAX_ROLLBACK), count = r.tick - first;
+    int header[3] = {first, count, r.remoteConfirmed};
+    std::string packet((char *)header, sizeof(header));
+    for (int t = first; t < r.tick; t++)
+        packet.append((char *)&r.inputs[t % ROLLBACK_HISTORY][r.local], sizeof(unsigned short));
+    r.link.send(packet, r.clock);
+}
+
+void receiveInputs(rollbackPeer &r)
+{
+    char buffer[2048];
+    int size;
+    while ((size = r.link.receive(buffer, sizeof(buffer))) >= (int)(3 * sizeof(int)))
+    {
+        int header[3];
+        memcpy(header, buffer, sizeof(header));
+        int first = header[0], count = std::min(header[1], (int)((size - sizeof(header)) / sizeof(unsigned short)));
+        r.localAcked = std::max(r.localAcked, header[2]);
+        for (int k = 0; k < count; k++)
+        {
+            int t = first + k;
+            if (t < r.remoteConfirmed)
+                continue;
+            if (t > r.remoteConfirmed)
+                break; // a packet got lost, the next one will resend it
+            unsigned short in;
+            memcpy(&in, buffer + sizeof(header) + k * sizeof(unsigned short), sizeof(in));
+            unsigned short &slot = r.inputs[t % ROLLBACK_HISTORY][r.remote];
+            if (t < r.tick && slot != in && (r.rollbackFrom == -1 || t < r.rollbackFrom))
+                r.rollbackFrom = t;
+            slot = in;
+            r.remoteConfirmed++;
+        }
+    }
+}
+
+// receive the remote inputs, and fix the past if some predictions were wrong
+void synchronize(rollbackPeer &r)
+{
+    receiveInputs(r);
+    if (r.rollbackFrom == -1)
+        return;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    r.state = r.snapshots[r.rollbackFrom % ROLLBACK_HISTORY];
+    for (int t = r.rollbackFrom; t < r.tick; t++)
+    {
+        if (t != r.rollbackFrom)
+            r.snapshots[t % ROLLBACK_HISTORY] = r.state;
+        simulateTick(r, t);
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    r.rollbacks++;
+    r.resimulated += r.tick - r.rollbackFrom;
+    r.maxResimulation = std::max(r.maxResimulation, elapsed);
+    r.rollbackFrom = -1;
+}
+
+// one frame: play the local input, return 0 if the peer had to wait for the other one instead
+bool advance(rollbackPeer &r, const gameInput &localInput)
+{
+    r.clock++;
+    r.link.flush(r.clock);
+    synchronize(r);
+    if (r.tick - r.remoteConfirmed >= MAX_ROLLBACK)
+    {
+        // too far ahead, wait for the other peer; keep resending so it can catch up
+        r.stalls++;
+        sendInputs(r);
+        return 0;
+    }
+
+    int slot = r.tick % ROLLBACK_HISTORY;
+    r.inputs[slot][r.local] = encodeInput(localInput);
+    if (r.tick >= r.remoteConfirmed)
+        r.inputs[slot][r.remote] = NO_INPUT; // prediction
+    r.snapshots[slot] = r.state;
+    simulateTick(r, r.tick);
+    r.tick++;
+    sendInputs(r);
+    return 1;
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+    Selfplay: let the heuristic bot (bot.h) play seeded games on every core and record each of its decisions
+    as training data (dataset.h)
+
+    Usage: selfplay DIR [games] [pieces] [threads] [seed] [replay file]
+    - defaults: 100 games of at most 1000 tetrominos, one thread per core, seed 1
+    - DIR gets chunk00000.bin, chunk00001.bin, ... and index.bin
+    - if a replay file is given, the games are also appended to it (replay.h)
+    - every thread buffers its own records, the writer thread is shared; if the disk is too slow,
+      the players wait for it instead of filling the memory
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "bot.h"
+#include "dataset.h"
+
+const double SELFPLAY_TICK = REPLAY_TICK;
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: selfplay DIR [games] [pieces] [threads] [seed] [replay file]\n";
+        return 1;
+    }
+    std::string directory = argv[1];
+    int games = argc > 2 ? std::max(1, atoi(argv[2])) : 100;
+    int pieces = argc > 3 ? std::max(1, atoi(argv[3])) : 1000;
+    int threadCount = argc > 4 ? std::max(1, atoi(argv[4])) : std::max(1u, std::thread::hardware_concurrency());
+    unsigned long long seed = argc > 5 ? strtoull(argv[5], nullptr, 10) : 1;
+    std::string replayFile = argc > 6 ? argv[6] : "";
+    std::vector<replay> replays(replayFile.empty() ? 0 : games);
+
+    datasetWriter writer(directory);
+    std::atomic<int> next(0);
+    std::atomic<long long> decisionCount(0), score(0);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    auto worker = [&]()
+    {
+        decisionTracker decisions(&writer);
+        int k;
+        while ((k = next++) < games)
+        {
+            botPlayer bot;
+            Game g(seed + k);
+            decisions.beginGame();
+            if (!replays.empty())
+                replays[k] = replay(seed + k);
+            while (g.locked < pieces && g.isPlaying)
+            {
+                gameInput in = botInput(bot, g);
+                if (!replays.empty())
+                    replays[k].inputs.push_back(encodeInput(in));
+                updateGame(g, in, SELFPLAY_TICK);
+                observeGame(decisions, g);
+            }
+            decisionCount += g.locked;
+            score += g.score;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    writer.close();
+    if (!replayFile.empty() && !saveReplays(replayFile, replays))
+        std::cerr << "cannot save " << replayFile << "\n";
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // the writer thread is done, its count is the one in the files
+    std::cout << games << " games, " << decisionCount << " decisions, " << writer.total << " records, average score " << score / games << "\n";
+    std::cout << std::fixed << std::setprecision(2) << elapsed << " s, " << std::setprecision(0) << writer.total / elapsed
+              << " records/s, " << writer.chunks.size() << " chunk(s) in " << directory << "\n";
+    return 0;
+}
@@ -0,0 +1,696 @@
+/*
+    Headless game server: hosts many solo or versus games in one process (Linux only)
+
+    Usage: server [--port P] [--unix PATH] [--threads N] [--loopback GAMES SECONDS]
+    - listens on TCP port P (default 7777) and on the unix socket PATH (default /tmp/kana_tetris.sock)
+    - sessions are spread over N worker threads (default: one per core), each with its own epoll loop
+    - stops on SIGINT or SIGTERM
+    - --loopback: no listening, GAMES clients are connected through socketpairs instead and play random inputs
+      for SECONDS seconds, then the server prints how many game ticks it simulated
+
+    Protocol, one command per line
+    client -> server:
+        JOIN SOLO | JOIN VERSUS
+        LEFT | RIGHT | CW | CCW | SOFT | DROP | HOLD | RELEASE | QUIT
+    server -> client:
+        WAIT                                     waiting for a versus opponent
+        WELCOME <session> <player>
+        STATE <player> <score> <line> <level> <piece> <hold> <countdown> <x y of the 4 blocks of the piece>
+              <200 cells, row by row>    sent whenever anything in it changed, the falling piece included
+        GARBAGE <player> <rows>
+        END <winner>                             -1 for a solo game
+
+    The games are run by updateGame() from game.h, the server is the only one who knows the real state
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include "versus.h"
+
+// Server's game time step
+const double SERVER_TICK = 1.0 / 60;
+
+// bytes waiting for a client, a client that stops reading is dropped past this
+const size_t MAX_BACKLOG = 1 << 20;
+
+// bytes the acceptor keeps for a client that has not joined a game yet
+const size_t MAX_JOINING = 512;
+
+bool setNonBlocking(const int &fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+// turn a line of the protocol into an input for the game, return 0 if the command is not an input
+bool parseInput(const std::string &command, gameInput &in)
+{
+    if (command == "LEFT")
+        in.dx = -1;
+    else if (command == "RIGHT")
+        in.dx = 1;
+    else if (command == "CW")
+        in.rotate_cw = 1;
+    else if (command == "CCW")
+        in.rotate_ccw = 1;
+    else if (command == "SOFT")
+        in.softDrop = 1;
+    else if (command == "DROP")
+        in.hardDrop = 1;
+    else if (command == "HOLD")
+        in.hold = 1;
+    else if (command == "RELEASE")
+        in.keyRelease = 1, in.softDropRelease = 1;
+    else
+        return 0;
+    return 1;
+}
+
+struct connection
+{
+    int fd;
+    std::string in, out; // bytes received but not parsed yet, bytes not sent yet
+    int session, player;
+    bool writing;        // waiting for the socket to be writable again
+};
+
+struct session
+{
+    int id;
+    int players;
+    versus v;
+    int fd[2];                         // -1 once the player is gone, -2 when the player asked to quit
+    std::vector<gameInput> pending[2]; // inputs received since the last tick
+    std::string state[2];              // last STATE sent for each player
+    bool over;
+};
+
+// a connection handed from the acceptor to a worker
+struct handoff
+{
+    int session, players;
+    int fd[2];
+    std::string in[2];
+};
+
+struct worker
+{
+    int epfd, wakefd;
+    std::mutex mailboxLock;
+    std::vector<handoff> mailbox;
+    std::unordered_map<int, connection> connections;
+    std::unordered_map<int, session> sessions;
+    long long ticks; // games updated so far
+};
+
+std::atomic<bool> running(1);
+
+void stop(int)
+{
+    running = 0;
+}
+
+void flush(worker &w, connection &c)
+{
+    while (!c.out.empty())
+    {
+        ssize_t sent = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if (sent <= 0)
+            break;
+        c.out.erase(0, sent);
+    }
+    // wait for EPOLLOUT only while something is left to send
+    bool writing = !c.out.empty();
+    if (writing != c.writing)
+    {
+        epoll_event ev;
+        ev.events = EPOLLIN | (writing ? (uint32_t)EPOLLOUT : (uint32_t)0);
+        ev.data.fd = c.fd;
+        epoll_ctl(w.epfd, EPOLL_CTL_MOD, c.fd, &ev);
+        c.writing = writing;
+    }
+}
+
+void closeConnection(worker &w, const int &fd);
+
+void sendAll(worker &w, session &s, const std::string &message)
+{
+    for (int p = 0; p < s.players; p++)
+    {
+        if (s.fd[p] < 0)
+            continue;
+        connection &c = w.connections[s.fd[p]];
+        c.out += message;
+        // the session ends at its next tick, like for any player who left
+        if (c.out.size() > MAX_BACKLOG)
+            closeConnection(w, c.fd);
+    }
+}
+
+std::string stateMessage(const session &s, const int &p)
+{
+    const Game &g = s.v.games[p];
+    std::string m = "STATE " + std::to_string(p) + " " + std::to_string(g.score) + " " + std::to_string(g.line) + " " +
+                    std::to_string(g.level) + " " + std::to_string(g.tetra.color) + " " + std::to_string(g.heldTetromino) + " " +
+                    std::to_string(g.gameStarted ? 0 : g.countdown) + " ";
+    for (int i = 0; i < 4; i++)
+        m += std::to_string(g.tetra.block[i].x) + " " + std::to_string(g.tetra.block[i].y) + " ";
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            m += char('0' + g.boardStates[i][j]);
+    return m + "\n";
+}
+
+void closeConnection(worker &w, const int &fd)
+{
+    std::unordered_map<int, connection>::iterator it = w.connections.find(fd);
+    if (it == w.connections.end())
+        return;
+    std::unordered_map<int, session>::iterator s = w.sessions.find(it->second.session);
+    if (s != w.sessions.end())
+        s->second.fd[it->second.player] = -1;
+    epoll_ctl(w.epfd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    w.connections.erase(it);
+}
+
+void endSession(worker &w, session &s, const int &winner)
+{
+    s.over = 1;
+    sendAll(w, s, "END " + std::to_string(winner) + "\n");
+    for (int p = 0; p < s.players; p++)
+    {
+        if (s.fd[p] < 0)
+            continue;
+        int fd = s.fd[p];
+        flush(w, w.connections[fd]);
+        closeConnection(w, fd);
+    }
+}
+
+void handleLine(worker &w, connection &c, const std::string &command)
+{
+    // a connection can outlive its session for a moment, what it sends then is ignored
+    std::unordered_map<int, session>::iterator it = w.sessions.find(c.session);
+    if (it == w.sessions.end())
+        return;
+    session &s = it->second;
+    gameInput in;
+    if (parseInput(command, in))
+        s.pending[c.player].push_back(in);
+    else if (command == "QUIT")
+        s.fd[c.player] = -2; // closed after this read, the session notices at its next tick
+}
+
+void adopt(worker &w, handoff &h)
+{
+    session &s = w.sessions[h.session];
+    s.id = h.session;
+    s.players = h.players;
+    s.v = versus(h.players);
+    s.over = 0;
+    for (int p = 0; p < h.players; p++)
+    {
+        s.fd[p] = h.fd[p];
+        s.state[p].clear();
+
+        connection &c = w.connections[h.fd[p]];
+        c.fd = h.fd[p];
+        c.session = h.session;
+        c.player = p;
+        c.writing = 0;
+        c.out = "WELCOME " + std::to_string(h.session) + " " + std::to_string(p) + "\n";
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = c.fd;
+        epoll_ctl(w.epfd, EPOLL_CTL_ADD, c.fd, &ev);
+
+        // whatever came after the JOIN line is parsed as if it had just arrived
+        size_t start = 0, end;
+        while ((end = h.in[p].find('\n', start)) != std::string::npos)
+        {
+            handleLine(w, c, h.in[p].substr(start, end - start));
+            start = end + 1;
+        }
+        c.in = h.in[p].substr(start);
+
+        // QUIT came with the JOIN, there will be no read to close it
+        if (s.fd[p] == -2)
+            closeConnection(w, h.fd[p]);
+    }
+}
+
+void tickSession(worker &w, session &s)
+{
+    for (int p = 0; p < s.players; p++)
+    {
+        if (s.fd[p] < 0)
+        {
+            // a player left: in versus the other one wins
+            endSession(w, s, s.players == 2 ? 1 - p : -1);
+            return;
+        }
+    }
+
+    for (int p = 0; p < s.players; p++)
+    {
+        Game &g = s.v.games[p];
+
+        // the first input gets the tick's time, the others are applied at the same instant
+        if (s.pending[p].empty())
+            updateGame(g, gameInput(), SERVER_TICK);
+        for (size_t i = 0; i < s.pending[p].size(); i++)
+            updateGame(g, s.pending[p][i], i ? 0 : SERVER_TICK);
+        s.pending[p].clear();
+        w.ticks++;
+
+        int attack = settleVersus(s.v, p);
+        if (attack > 0)
+            sendAll(w, s, "GARBAGE " + std::to_string(1 - p) + " " + std::to_string(attack) + "\n");
+    }
+
+    // the states go out after both games moved, so garbage that just came up is in them
+    for (int p = 0; p < s.players; p++)
+    {
+        std::string state = stateMessage(s, p);
+        if (state == s.state[p])
+            continue;
+        s.state[p].swap(state);
+        sendAll(w, s, s.state[p]);
+    }
+
+    for (int p = 0; p < s.players; p++)
+    {
+        if (!s.v.games[p].isPlaying)
+        {
+            endSession(w, s, s.players == 2 ? 1 - p : -1);
+            return;
+        }
+    }
+}
+
+void runWorker(worker &w)
+{
+    std::chrono::steady_clock::duration tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SERVER_TICK));
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now() + tick;
+    epoll_event events[256];
+    char buffer[4096];
+
+    while (running)
+    {
+        int timeout = std::max(0, (int)std::chrono::duration_cast<std::chrono::milliseconds>(next - std::chrono::steady_clock::now()).count());
+        int n = epoll_wait(w.epfd, events, 256, timeout);
+        for (int i = 0; i < n; i++)
+        {
+            int fd = events[i].data.fd;
+            if (fd == w.wakefd)
+            {
+                // new sessions from the acceptor
+                unsigned long long count;
+                if (read(w.wakefd, &count, sizeof(count)) < 0)
+                    continue;
+                std::vector<handoff> arrived;
+                {
+                    std::lock_guard<std::mutex> guard(w.mailboxLock);
+                    arrived.swap(w.mailbox);
+                }
+                for (size_t k = 0; k < arrived.size(); k++)
+                    adopt(w, arrived[k]);
+                continue;
+            }
+
+            std::unordered_map<int, connection>::iterator it = w.connections.find(fd);
+            if (it == w.connections.end())
+                continue;
+            connection &c = it->second;
+            if (events[i].events & EPOLLOUT)
+                flush(w, c);
+            if (!(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)))
+                continue;
+
+            bool closed = 0;
+            while (1)
+            {
+                ssize_t got = recv(fd, buffer, sizeof(buffer), 0);
+                if (got > 0)
+                    c.in.append(buffer, got);
+                else
+                {
+                    closed = got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                    break;
+                }
+            }
+            size_t start = 0, end;
+            while ((end = c.in.find('\n', start)) != std::string::npos)
+            {
+                handleLine(w, c, c.in.substr(start, end - start));
+                start = end + 1;
+            }
+            c.in.erase(0, start);
+            std::unordered_map<int, session>::iterator owner = w.sessions.find(c.session);
+            if (closed || owner == w.sessions.end() || owner->second.fd[c.player] == -2)
+                closeConnection(w, fd);
+        }
+
+        // one tick for every session of this worker, late ticks are caught up one by one
+        if (std::chrono::steady_clock::now() >= next)
+        {
+            next += tick;
+            std::vector<int> finished;
+            for (std::unordered_map<int, session>::iterator it = w.sessions.begin(); it != w.sessions.end(); it++)
+            {
+                tickSession(w, it->second);
+                if (it->second.over)
+                    finished.push_back(it->first);
+            }
+            for (size_t k = 0; k < finished.size(); k++)
+                w.sessions.erase(finished[k]);
+            for (std::unordered_map<int, connection>::iterator it = w.connections.begin(); it != w.connections.end(); it++)
+                flush(w, it->second);
+        }
+    }
+}
+
+/*
+    The acceptor reads the JOIN line of every new connection, then hands it to the worker owning its session
+    Both players of a versus game always end up on the same worker, so a session is only touched by one thread
+*/
+struct acceptor
+{
+    int epfd;
+    std::vector<int> listeners;
+    std::unordered_map<int, std::string> joining; // connections that have not sent JOIN yet
+    int waiting;                                  // versus player without an opponent, -1 if none
+    int nextSession;
+    std::vector<worker *> workers;
+
+    void add(const int &fd)
+    {
+        setNonBlocking(fd);
+        joining[fd] = "";
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void drop(const int &fd)
+    {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, fd, nullptr);
+        joining.erase(fd);
+        close(fd);
+        if (fd == waiting)
+            waiting = -1;
+    }
+
+    void dispatch(handoff &h)
+    {
+        for (int p = 0; p < h.players; p++)
+        {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, h.fd[p], nullptr);
+            joining.erase(h.fd[p]);
+        }
+        worker &w = *workers[h.session % workers.size()];
+        {
+            std::lock_guard<std::mutex> guard(w.mailboxLock);
+            w.mailbox.push_back(h);
+        }
+        unsigned long long one = 1;
+        if (write(w.wakefd, &one, sizeof(one)) < 0)
+            perror("write");
+    }
+
+    void readJoin(const int &fd)
+    {
+        char buffer[512];
+        ssize_t got;
+        std::string &in = joining[fd];
+        while ((got = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+            in.append(buffer, got);
+        if (got == 0 || (got < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+        {
+            drop(fd);
+            return;
+        }
+        size_t end = in.find('\n');
+        if (end == std::string::npos || fd == waiting)
+        {
+            // no JOIN line yet, or a versus player still waiting: nothing worth that much can have been sent
+            if (in.size() > MAX_JOINING)
+                drop(fd);
+            return;
+        }
+
+        std::string command = in.substr(0, end), rest = in.substr(end + 1);
+        handoff h;
+        h.session = nextSession++;
+        if (command == "JOIN SOLO")
+        {
+            h.players = 1;
+            h.fd[0] = fd, h.in[0] = rest;
+            dispatch(h);
+        }
+        else if (command == "JOIN VERSUS")
+        {
+            if (waiting == -1)
+            {
+                waiting = fd, in = rest;
+                send(fd, "WAIT\n", 5, MSG_NOSIGNAL);
+                nextSession--;
+                return;
+            }
+            h.players = 2;
+            h.fd[0] = waiting, h.in[0] = joining[waiting];
+            h.fd[1] = fd, h.in[1] = rest;
+            waiting = -1;
+            dispatch(h);
+        }
+        else
+            drop(fd);
+    }
+
+    void run()
+    {
+        epoll_event events[64];
+        while (running)
+        {
+            int n = epoll_wait(epfd, events, 64, 100);
+            for (int i = 0; i < n; i++)
+            {
+                int fd = events[i].data.fd;
+                if (std::find(listeners.begin(), listeners.end(), fd) != listeners.end())
+                {
+                    int client;
+                    while ((client = accept(fd, nullptr, nullptr)) != -1)
+                        add(client);
+                }
+                else
+                    readJoin(fd);
+            }
+        }
+    }
+};
+
+int listenTcp(const int &port)
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(fd, (sockaddr *)&address, sizeof(address)) == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        perror("tcp");
+        close(fd);
+        return -1;
+    }
+    setNonBlocking(fd);
+    return fd;
+}
+
+int listenUnix(const std::string &path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    unlink(path.c_str());
+    if (bind(fd, (sockaddr *)&address, sizeof(address)) == -1 || listen(fd, SOMAXCONN) == -1)
+    {
+        perror("unix");
+        close(fd);
+        return -1;
+    }
+    setNonBlocking(fd);
+    return fd;
+}
+
+/*
+    Loopback clients: the client ends of socketpairs, played by one thread pressing random keys
+    Half of them play solo, the other half versus
+*/
+void runLoopbackClients(std::vector<int> fds, const double &seconds, long long &messages)
+{
+    const char *keys[] = {"LEFT\n", "RIGHT\n", "CW\n", "CCW\n", "SOFT\n", "RELEASE\n", "DROP\nRELEASE\n", "HOLD\n"};
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        const char *join = (i % 2) ? "JOIN SOLO\n" : "JOIN VERSUS\n";
+        send(fds[i], join, strlen(join), MSG_NOSIGNAL);
+        setNonBlocking(fds[i]);
+    }
+
+    char buffer[65536];
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    while (std::chrono::steady_clock::now() < end)
+    {
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            if (fds[i] == -1)
+                continue;
+            ssize_t got;
+            while ((got = recv(fds[i], buffer, sizeof(buffer), 0)) > 0)
+                messages += std::count(buffer, buffer + got, '\n');
+            if (got == 0)
+            {
+                // the game is over
+                close(fds[i]);
+                fds[i] = -1;
+                continue;
+            }
+            const char *key = keys[rng() % 8];
+            send(fds[i], key, strlen(key), MSG_NOSIGNAL);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (size_t i = 0; i < fds.size(); i++)
+        if (fds[i] != -1)
+            close(fds[i]);
+}
+
+int main(int argc, char **argv)
+{
+    int port = 7777, threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::string unixPath = "/tmp/kana_tetris.sock";
+    int loopbackGames = 0;
+    double loopbackSeconds = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc)
+            port = atoi(argv[++i]);
+        else if (arg == "--unix" && i + 1 < argc)
+            unixPath = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            threadCount = std::max(1, atoi(argv[++i]));
+        else if (arg == "--loopback" && i + 2 < argc)
+        {
+            loopbackGames = atoi(argv[++i]);
+            loopbackSeconds = atof(argv[++i]);
+        }
+        else
+        {
+            std::cerr << "usage: server [--port P] [--unix PATH] [--threads N] [--loopback GAMES SECONDS]\n";
+            return 1;
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+    std::srand(std::time(NULL));
+
+    std::vector<worker> workers(threadCount);
+    acceptor a;
+    a.epfd = epoll_create1(0);
+    a.waiting = -1;
+    a.nextSession = 0;
+    for (int i = 0; i < threadCount; i++)
+    {
+        workers[i].epfd = epoll_create1(0);
+        workers[i].wakefd = eventfd(0, EFD_NONBLOCK);
+        workers[i].ticks = 0;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = workers[i].wakefd;
+        epoll_ctl(workers[i].epfd, EPOLL_CTL_ADD, workers[i].wakefd, &ev);
+        a.workers.push_back(&workers[i]);
+    }
+
+    std::vector<int> clientFds;
+    if (loopbackGames)
+    {
+        for (int i = 0; i < loopbackGames; i++)
+        {
+            int pair[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) == -1)
+            {
+                perror("socketpair");
+                return 1;
+            }
+            a.add(pair[0]);
+            clientFds.push_back(pair[1]);
+        }
+    }
+    else
+    {
+        int fds[2] = {listenTcp(port), listenUnix(unixPath)};
+        for (int i = 0; i < 2; i++)
+        {
+            if (fds[i] == -1)
+                continue;
+            a.listeners.push_back(fds[i]);
+            epoll_event ev;
+            ev.events = EPOLLIN;
+            ev.data.fd = fds[i];
+            epoll_ctl(a.epfd, EPOLL_CTL_ADD, fds[i], &ev);
+        }
+        if (a.listeners.empty())
+            return 1;
+        std::cout << "listening on port " << port << " and " << unixPath << " with " << threadCount << " worker(s)\n";
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(runWorker, std::ref(workers[i])));
+    std::thread acceptorThread(&acceptor::run, &a);
+
+    if (loopbackGames)
+    {
+        long long messages = 0;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        runLoopbackClients(clientFds, loopbackSeconds, messages);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        running = 0;
+        acceptorThread.join();
+        for (int i = 0; i < threadCount; i++)
+            threads[i].join();
+
+        long long ticks = 0;
+        for (int i = 0; i < threadCount; i++)
+            ticks += workers[i].ticks;
+        std::cout << loopbackGames << " clients, " << threadCount << " worker(s), " << elapsed << " s\n"
+                  << ticks << " game ticks (" << ticks / elapsed << " per second), "
+                  << messages << " messages received by the clients\n";
+        return 0;
+    }
+
+    acceptorThread.join();
+    for (int i = 0; i < threadCount; i++)
+        threads[i].join();
+    unlink(unixPath.c_str());
+    return 0;
+}
@@ -0,0 +1,277 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "placement.h"
+
+/*
+    Perfect clear solver
+    Given the board, the known pieces and the hold, find a sequence of placements that leaves the board empty
+    The search is a depth first search over getPlacements(), the same rules the game uses, with some pruning:
+    - Fill count: a perfect clear of height h needs exactly (10h - filled cells) / 4 more pieces
+    - Nothing is pruned on the shape of the empty cells (regions of 4, checkerboard parity): a line cleared before the
+      last piece moves the rows above it down, which joins regions and flips colors, so those prunes lose solutions
+    - Visited boards: the same (board, queue potision, hold) is never searched twice, by any thread
+    The first move is split among all cores, the visited boards are shared so no thread searches what another already did
+*/
+
+struct pcStep // one placement of the solution
+{
+    Tetromino t;
+    bool hold;   // the hold button was used before this placement
+    int cleared; // lines cleared by this placement
+};
+
+struct pcSolution
+{
+    bool found;
+    std::vector<pcStep> steps;
+    long long nodes;
+    pcSolution()
+    {
+        found = 0, nodes = 0;
+    }
+};
+
+// count the occupied cells of the board
+int countFilled(const board &b)
+{
+    int filled = 0;
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            if (b[i][j])
+                filled++;
+    return filled;
+}
+
+// key of a search node: occupancy of every cell, potision in the queue, the held piece and the clear height left
+struct pcKey
+{
+    unsigned long long w[4];
+    bool operator==(const pcKey &o) const
+    {
+        return w[0] == o.w[0] && w[1] == o.w[1] && w[2] == o.w[2] && w[3] == o.w[3];
+    }
+};
+
+struct pcKeyHash
+{
+    size_t operator()(const pcKey &k) const
+    {
+        unsigned long long h = 0;
+        for (int i = 0; i < 4; i++)
+            h = (h ^ k.w[i]) * 0x100000001b3ULL + (h >> 29);
+        return h;
+    }
+};
+
+pcKey getKey(const board &b, const int &index, const int &hold, const int &height)
+{
+    pcKey k = {{0, 0, 0, 0}};
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            if (b[i][j])
+            {
+                int c = i * COLUMN + j;
+                k.w[c / 64] |= 1ULL << (c % 64);
+            }
+    k.w[3] |= ((unsigned long long)(index * 8 + hold + 1) * 32 + height) << 16;
+    return k;
+}
+
+struct pcChoice // which piece is played, and what is left in the queue and the hold
+{
+    int piece, next, hold;
+    bool usedHold;
+};
+
+// the pieces that can be played at this potision of the queue
+std::vector<pcChoice> getChoices(const std::vector<int> &queue, const int &index, const int &hold, const bool &canHold)
+{
+    std::vector<pcChoice> choices;
+    if (index >= (int)queue.size())
+    {
+        // nothing left in the queue, only the held piece can be played
+        if (canHold && hold != -1)
+            choices.push_back({hold, index, -1, 1});
+        return choices;
+    }
+    choices.push_back({queue[index], index + 1, hold, 0});
+    if (!canHold || hold == queue[index])
+        return choices;
+    if (hold == -1)
+    {
+        // holding for the first time, the next piece is taken from the queue
+        if (index + 1 < (int)queue.size())
+            choices.push_back({queue[index + 1], index + 2, queue[index], 1});
+    }
+    else
+        choices.push_back({hold, index + 1, queue[index], 1});
+    return choices;
+}
+
+// the search nodes already seen by any thread; a key only locks the stripe it falls in, so the threads rarely wait
+struct pcVisited
+{
+    static const int STRIPES = 64;
+    std::mutex locks[STRIPES];
+    std::unordered_set<pcKey, pcKeyHash> sets[STRIPES];
+
+    // return 0 if the key was already there
+    bool insert(const pcKey &k)
+    {
+        int stripe = (pcKeyHash()(k) >> 32) % STRIPES;
+        std::lock_guard<std::mutex> guard(locks[stripe]);
+        return sets[stripe].insert(k).second;
+    }
+};
+
+struct pcSearch
+{
+    const std::vector<int> *queue;
+    int maxPieces;
+    std::atomic<bool> *found;
+    pcVisited *visited;
+    std::vector<pcStep> path;
+    long long nodes;
+};
+
+// the pieces left to play, capped by the limit of the search
+int piecesLeft(const pcSearch &s, const int &index, const int &hold, const int &used)
+{
+    int left = std::max(0, (int)s.queue->size() - index) + (hold != -1);
+    return std::min(left, s.maxPieces - used);
+}
+
+bool searchPerfectClear(pcSearch &s, const board &b, const int &index, const int &hold, const bool &canHold, const int &used, const int &height);
+
+// place one piece and keep searching from the resulting board
+bool tryPlacement(pcSearch &s, const board &b, const pcChoice &c, const Tetromino &t, const int &used, const int &height)
+{
+    // the tetromino must stay below the perfect clear line
+    for (int i = 0; i < 4; i++)
+        if (t.block[i].y < ROWS - height)
+            return 0;
+
+    s.nodes++;
+    board next = b;
+    lockTetromino(t, next);
+    int cleared = clearLines(next);
+    s.path.push_back({t, c.usedHold, cleared});
+
+    int newHeight = height - cleared;
+    if (newHeight == 0)
+        return 1;
+
+    int empty = newHeight * COLUMN - countFilled(next);
+    if (empty / 4 <= piecesLeft(s, c.next, c.hold, used + 1))
+    {
+        if (s.visited->insert(getKey(next, c.next, c.hold, newHeight)))
+        {
+            if (searchPerfectClear(s, next, c.next, c.hold, 1, used + 1, newHeight))
+                return 1;
+        }
+    }
+    s.path.pop_back();
+    return 0;
+}
+
+bool searchPerfectClear(pcSearch &s, const board &b, const int &index, const int &hold, const bool &canHold, const int &used, const int &height)
+{
+    if (*s.found)
+        return 0;
+    std::vector<pcChoice> choices = getChoices(*s.queue, index, hold, canHold);
+    for (size_t i = 0; i < choices.size(); i++)
+    {
+        std::vector<Tetromino> placements = getPlacements(b, choices[i].piece);
+        for (size_t j = 0; j < placements.size(); j++)
+        {
+            if (tryPlacement(s, b, choices[i], placements[j], used, height))
+                return 1;
+        }
+    }
+    return 0;
+}
+
+// try to clear the whole board within maxPieces pieces
+// queue[0] is the current piece, followed by the known upcoming pieces; hold is -1 if nothing is held
+pcSolution solvePerfectClear(const board &b, const std::vector<int> &queue, const int &hold, const bool &canHold, const int &maxPieces)
+{
+    pcSolution solution;
+    int filled = countFilled(b);
+    int available = std::min((int)queue.size() + (hold != -1), maxPieces);
+    pcVisited visited; // the clear height is part of the key, it can be kept from one height to the next
+
+    for (int height = std::max(stackHeight(b), 1); height <= ROWS; height++)
+    {
+        int cells = height * COLUMN - filled;
+        if (cells % 4)
+            continue;
+        if (cells / 4 > available)
+            break;
+
+        // split the first move among the threads
+        struct rootMove
+        {
+            pcChoice c;
+            Tetromino t;
+        };
+        std::vector<rootMove> roots;
+        std::vector<pcChoice> choices = getChoices(queue, 0, hold, canHold);
+        for (size_t i = 0; i < choices.size(); i++)
+        {
+            std::vector<Tetromino> placements = getPlacements(b, choices[i].piece);
+            for (size_t j = 0; j < placements.size(); j++)
+                roots.push_back({choices[i], placements[j]});
+        }
+
+        std::atomic<bool> found(0);
+        std::atomic<int> nextRoot(0);
+        std::atomic<long long> nodes(0);
+        std::mutex resultLock;
+        auto worker = [&]()
+        {
+            pcSearch s;
+            s.queue = &queue;
+            s.maxPieces = maxPieces;
+            s.found = &found;
+            s.visited = &visited;
+            s.nodes = 0;
+            int r;
+            while (!found && (r = nextRoot++) < (int)roots.size())
+            {
+                s.path.clear();
+                if (tryPlacement(s, b, roots[r].c, roots[r].t, 0, height))
+                {
+                    std::lock_guard<std::mutex> guard(resultLock);
+                    if (!found)
+                    {
+                        found = 1;
+                        solution.steps = s.path;
+                    }
+                }
+            }
+            nodes += s.nodes;
+        };
+
+        int threadCount = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<std::thread> threads;
+        for (int i = 1; i < threadCount; i++)
+            threads.push_back(std::thread(worker));
+        worker();
+        for (size_t i = 0; i < threads.size(); i++)
+            threads[i].join();
+
+        solution.nodes += nodes;
+        if (found)
+        {
+            solution.found = 1;
+            return solution;
+        }
+    }
+    return solution;
+}
+
+#endif
@@ -0,0 +1,126 @@
+/*
+    Spectator: a wall of bot games (bot.h) running at the same time, all of them in one window (wall.h)
+
+    Usage: spectator [boards] [threads] [speed]
+    - defaults: 120 boards, one thread per core, real time (speed 1)
+    - the games are split between the threads, every game publishes a small view of itself after each tick,
+      the window only draws the latest views and skips the boards that did not change
+    - a game that tops out starts again with a new seed after a few seconds
+    - the average frame time and the boards redrawn per frame are printed every few seconds
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "bot.h"
+#include "buffer.h"
+#include "wall.h"
+
+const double SPECTATOR_TICK = 1.0 / 60;
+const int RESTART_TICKS = 180;
+
+int main(int argc, char **argv)
+{
+    int boards = argc > 1 ? std::max(1, atoi(argv[1])) : 120;
+    int threadCount = argc > 2 ? std::max(1, atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    int speed = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+    threadCount = std::min(threadCount, boards);
+
+    std::vector<std::unique_ptr<tripleBuffer<boardView>>> views;
+    for (int i = 0; i < boards; i++)
+        views.push_back(std::unique_ptr<tripleBuffer<boardView>>(new tripleBuffer<boardView>(boardView())));
+    std::atomic<bool> running(1);
+
+    // thread t plays the games t, t + threadCount, ...
+    auto worker = [&](const int t)
+    {
+        std::vector<int> mine;
+        for (int i = t; i < boards; i += threadCount)
+            mine.push_back(i);
+        std::vector<Game> games;
+        std::vector<botPlayer> bots(mine.size());
+        std::vector<boardView> current(mine.size());
+        std::vector<int> waiting(mine.size(), 0);
+        unsigned long long seed = t + 1;
+        for (size_t k = 0; k < mine.size(); k++)
+            games.push_back(Game(mine[k] + 1));
+
+        std::chrono::steady_clock::duration tick = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(SPECTATOR_TICK));
+        std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+        while (running)
+        {
+            for (size_t k = 0; k < mine.size(); k++)
+            {
+                for (int s = 0; s < speed; s++)
+                {
+                    if (!games[k].isPlaying && ++waiting[k] >= RESTART_TICKS)
+                    {
+                        seed += boards;
+                        games[k] = Game(seed * 2654435761ULL + mine[k]);
+                        bots[k] = botPlayer();
+                        waiting[k] = 0;
+                    }
+                    updateGame(games[k], botInput(bots[k], games[k]), SPECTATOR_TICK);
+                }
+                if (makeView(games[k], current[k]))
+                {
+                    views[mine[k]]->writeBuffer() = current[k];
+                    views[mine[k]]->publish();
+                }
+            }
+            next += tick;
+            std::this_thread::sleep_until(next);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; t++)
+        threads.push_back(std::thread(worker, t));
+
+    sf::RenderWindow window(sf::VideoMode(1600, 900), "Kurisu - spectator");
+    window.setFramerateLimit(60);
+    sf::Texture atlas;
+    atlas.loadFromFile("textures/Tetromino.png");
+    spectatorWall wall(boards, atlas);
+    wall.layout(1600, 900);
+
+    sf::Clock clock;
+    double frameTime = 0;
+    long long frames = 0, rebuilt = 0;
+    while (window.isOpen())
+    {
+        sf::Event event;
+        while (window.pollEvent(event))
+        {
+            if (event.type == sf::Event::Closed || (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape))
+                window.close();
+            else if (event.type == sf::Event::Resized)
+            {
+                window.setView(sf::View(sf::FloatRect(0, 0, event.size.width, event.size.height)));
+                wall.layout(event.size.width, event.size.height);
+            }
+        }
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (int i = 0; i < boards; i++)
+            wall.update(i, views[i]->read());
+        window.clear(sf::Color(10, 10, 10));
+        wall.draw(window, atlas);
+        frameTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        window.display();
+
+        frames++;
+        if (clock.getElapsedTime().asSeconds() >= 5)
+        {
+            std::cout << std::fixed << std::setprecision(3) << frames / clock.restart().asSeconds() << " fps, "
+                      << 1000 * frameTime / frames << " ms to update and draw, "
+                      << std::setprecision(1) << (double)(wall.rebuilt - rebuilt) / frames << " boards redrawn per frame"
+                      << std::endl;
+            frames = 0, frameTime = 0, rebuilt = wall.rebuilt;
+        }
+    }
+
+    running = 0;
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    return 0;
+}
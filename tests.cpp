@@ -0,0 +1,158 @@
+/*
+    Tests: checks of the tools that are easy to get subtly wrong, run with bot games on a temporary folder
+
+    Usage: tests
+    - prints every failed check, the exit code is the number of failed tests
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "bot.h"
+#include "corpus.h"
+#include "dataset.h"
+#include "solver.h"
+
+int failures = 0;
+
+#define CHECK(condition)                                                        \
+    if (!(condition))                                                           \
+    {                                                                           \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " << #condition << "\n"; \
+        return 0;                                                               \
+    }
+
+std::string testDirectory(const std::string &name)
+{
+    std::string directory = (std::filesystem::temp_directory_path() / ("kana_tests_" + name)).string();
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+// two games stopped at a piece cap, recorded by the same tracker like selfplay does
+bool testCappedGames()
+{
+    const int PIECES = 50;
+    std::string directory = testDirectory("dataset");
+    long long decisions = 0;
+    {
+        datasetWriter writer(directory);
+        decisionTracker tracker(&writer);
+        for (int k = 0; k < 2; k++)
+        {
+            botPlayer bot;
+            Game g(1 + k);
+            tracker.beginGame();
+            while (g.locked < PIECES && g.isPlaying)
+                updateGame(g, botInput(bot, g), REPLAY_TICK), observeGame(tracker, g);
+            decisions += g.locked;
+        }
+        tracker.flush();
+        writer.close();
+        CHECK(writer.total == (unsigned long long)decisions);
+    }
+
+    FILE *file = fopen((directory + "/chunk00000.bin").c_str(), "rb");
+    CHECK(file);
+    chunkHeader h;
+    std::vector<decisionRecord> records(decisions + 1);
+    size_t read = fread(&h, sizeof(h), 1, file) ? fread(records.data(), sizeof(decisionRecord), records.size(), file) : 0;
+    fclose(file);
+    CHECK(read == (size_t)decisions && h.recordCount == (uint64_t)decisions);
+    std::set<uint32_t> games;
+    for (size_t i = 0; i < read; i++)
+    {
+        CHECK(records[i].scoreDelta >= 0);
+        CHECK(records[i].linesCleared <= 4);
+        games.insert(records[i].game);
+    }
+    CHECK(games.size() == 2);
+    CHECK(records[PIECES].move == 0);
+    std::filesystem::remove_all(directory);
+    return 1;
+}
+
+// a perfect clear that only works by clearing a line early: the O goes in a 2 cells pocket that is opened
+// by the J clearing the middle row, so no prune may look at the empty regions or colors of the first board
+bool testEarlyClearSolution()
+{
+    const char *rows[3] = {"..........", ".########.", ".#..#####."};
+    board b(ROWS, std::vector<int>(COLUMN, 0));
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < COLUMN; j++)
+            b[ROWS - 3 + i][j] = rows[i][j] == '#';
+    std::vector<int> queue = {0, 4, 1, 5, 2}; // I L O J S
+    pcSolution s = solvePerfectClear(b, queue, -1, 1, 10);
+    CHECK(s.found);
+    for (size_t i = 0; i < s.steps.size(); i++)
+    {
+        lockTetromino(s.steps[i].t, b);
+        clearLines(b);
+    }
+    CHECK(countFilled(b) == 0);
+    return 1;
+}
+
+// a range query must return exactly the positions a scan of the column finds, in the order of the feature
+template <typename T>
+bool checkRange(const corpusIndex &index, const mappedFile &column, const std::vector<uint32_t> &found, const int &low, const int &high)
+{
+    const T *value = column.as<T>();
+    size_t expected = 0;
+    for (size_t p = 0; p < index.positions; p++)
+        expected += value[p] >= low && value[p] <= high;
+    CHECK(found.size() == expected);
+    for (size_t i = 0; i < found.size(); i++)
+    {
+        CHECK(found[i] < index.positions && value[found[i]] >= low && value[found[i]] <= high);
+        CHECK(!i || value[found[i - 1]] <= value[found[i]]);
+    }
+    return 1;
+}
+
+// an index of a few bot games, queried by stack height, holes and lines cleared
+bool testCorpusRanges()
+{
+    std::string directory = testDirectory("corpus"), file = directory + ".rep";
+    std::vector<replay> games(3);
+    for (int k = 0; k < 3; k++)
+    {
+        botPlayer bot;
+        playGame(bot, 1 + k, 200, REPLAY_TICK, &games[k]);
+    }
+    std::filesystem::remove(file);
+    CHECK(saveReplays(file, games));
+    CHECK(buildCorpus(directory, std::vector<std::string>(1, file), 2));
+
+    corpusIndex index;
+    CHECK(index.open(directory));
+    CHECK(index.gameCount == 3 && index.positions > 0);
+    const int ranges[4][2] = {{0, 4}, {3, 8}, {10, 40}, {5, 2}};
+    for (int r = 0; r < 4; r++)
+    {
+        int low = ranges[r][0], high = ranges[r][1];
+        CHECK(checkRange<uint8_t>(index, index.height, index.heightRange(low, high), low, high));
+        CHECK(checkRange<uint8_t>(index, index.holes, index.holesRange(low, high), low, high));
+        CHECK(checkRange<uint16_t>(index, index.lines, index.linesRange(low, high), low, high));
+    }
+    CHECK(index.linesRange(0, 65535).size() == index.positions);
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove(file);
+    return 1;
+}
+
+int main()
+{
+    std::vector<std::pair<std::string, bool (*)()>> tests = {
+        {"capped games", testCappedGames},
+        {"corpus ranges", testCorpusRanges},
+        {"early clear solution", testEarlyClearSolution},
+    };
+    for (size_t i = 0; i < tests.size(); i++)
+    {
+        bool passed = tests[i].second();
+        failures += !passed;
+        std::cout << (passed ? "ok    " : "FAIL  ") << tests[i].first << "\n";
+    }
+    return failures;
+}
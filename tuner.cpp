@@ -0,0 +1,210 @@
+/*
+    Tuner: evolve the weights of the heuristic bot (bot.h) with a genetic algorithm
+    Every generation, each individual plays the same seeded games, spread over all cores,
+    its fitness is the average score. The games run through updateGame() at a fixed tick, so the
+    scoring, the leveling and the gravity are exactly the ones of the real game
+
+    Usage: tuner [--population P] [--games G] [--pieces N] [--generations K] [--threads T] [--checkpoint FILE]
+    - defaults: 24 individuals, 8 games each, at most 300 tetrominos per game, 20 generations, one thread per core
+    - the population is saved to FILE (default: tuner.txt) after every generation; if FILE exists, the tuner resumes from it
+*/
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "bot.h"
+
+const double TUNER_TICK = 1.0 / 60;
+
+struct individual
+{
+    botWeights weights;
+    double fitness;
+};
+
+// the rating of a board does not change if every weight is multiplied by the same positive number
+void normalize(botWeights &w)
+{
+    double length = 0;
+    for (int i = 0; i < FEATURE_COUNT; i++)
+        length += w.w[i] * w.w[i];
+    length = std::sqrt(length);
+    if (length > 0)
+        for (int i = 0; i < FEATURE_COUNT; i++)
+            w.w[i] /= length;
+}
+
+bool saveCheckpoint(const std::string &file, const int &generation, const std::vector<individual> &population)
+{
+    // written next to the old one, then renamed, so an interrupted save never loses the checkpoint
+    std::string temporary = file + ".tmp";
+    std::ofstream out(temporary);
+    out << "generation " << generation << "\n";
+    out << std::setprecision(17);
+    for (size_t i = 0; i < population.size(); i++)
+    {
+        for (int k = 0; k < FEATURE_COUNT; k++)
+            out << population[i].weights.w[k] << " ";
+        out << population[i].fitness << "\n";
+    }
+    out.close();
+    return out && std::rename(temporary.c_str(), file.c_str()) == 0;
+}
+
+bool loadCheckpoint(const std::string &file, int &generation, std::vector<individual> &population)
+{
+    std::ifstream in(file);
+    std::string word;
+    if (!(in >> word >> generation) || word != "generation")
+        return 0;
+    population.clear();
+    individual x;
+    while (1)
+    {
+        for (int k = 0; k < FEATURE_COUNT; k++)
+            in >> x.weights.w[k];
+        if (!(in >> x.fitness))
+            break;
+        population.push_back(x);
+    }
+    return !population.empty();
+}
+
+// every individual plays the same games, (individual, game) pairs are handed to the threads one by one
+void evaluate(std::vector<individual> &population, const int &games, const int &pieces, const unsigned long long &seed, const int &threadCount)
+{
+    std::vector<std::vector<double>> scores(population.size(), std::vector<double>(games));
+    std::atomic<int> next(0);
+    int total = population.size() * games;
+    auto worker = [&]()
+    {
+        int job;
+        while ((job = next++) < total)
+        {
+            int i = job / games, k = job % games;
+            botPlayer bot(population[i].weights);
+            Game g = playGame(bot, seed + k, pieces, TUNER_TICK);
+            scores[i][k] = g.score;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < threadCount; t++)
+        threads.push_back(std::thread(worker));
+    worker();
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    for (size_t i = 0; i < population.size(); i++)
+        population[i].fitness = std::accumulate(scores[i].begin(), scores[i].end(), 0.0) / games;
+}
+
+// the fittest of a few random individuals
+const individual &tournament(const std::vector<individual> &population, std::mt19937 &rng)
+{
+    const individual *best = &population[rng() % population.size()];
+    for (int i = 0; i < 2; i++)
+    {
+        const individual &other = population[rng() % population.size()];
+        if (other.fitness > best->fitness)
+            best = &other;
+    }
+    return *best;
+}
+
+// next generation: the best quarter survives, the others are mixes of two parents with some noise
+std::vector<individual> breed(std::vector<individual> population, std::mt19937 &rng)
+{
+    std::sort(population.begin(), population.end(), [](const individual &a, const individual &b)
+              { return a.fitness > b.fitness; });
+    int elites = std::max(1, (int)population.size() / 4);
+    std::vector<individual> children(population.begin(), population.begin() + elites);
+    std::uniform_real_distribution<double> mix(0, 1);
+    std::normal_distribution<double> noise(0, 0.1);
+    while (children.size() < population.size())
+    {
+        const individual &a = tournament(population, rng), &b = tournament(population, rng);
+        individual child;
+        for (int k = 0; k < FEATURE_COUNT; k++)
+        {
+            double t = mix(rng);
+            child.weights.w[k] = t * a.weights.w[k] + (1 - t) * b.weights.w[k] + noise(rng);
+        }
+        normalize(child.weights);
+        child.fitness = 0;
+        children.push_back(child);
+    }
+    return children;
+}
+
+int main(int argc, char **argv)
+{
+    int populationSize = 24, games = 8, pieces = 300, generations = 20;
+    int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::string checkpoint = "tuner.txt";
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "--population")
+            populationSize = std::max(2, atoi(argv[i + 1]));
+        else if (arg == "--games")
+            games = std::max(1, atoi(argv[i + 1]));
+        else if (arg == "--pieces")
+            pieces = std::max(1, atoi(argv[i + 1]));
+        else if (arg == "--generations")
+            generations = atoi(argv[i + 1]);
+        else if (arg == "--threads")
+            threadCount = std::max(1, atoi(argv[i + 1]));
+        else if (arg == "--checkpoint")
+            checkpoint = argv[i + 1];
+        else
+        {
+            std::cerr << "unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    int generation = 0;
+    std::vector<individual> population;
+    if (loadCheckpoint(checkpoint, generation, population))
+        std::cout << "resuming " << checkpoint << " at generation " << generation << "\n";
+    else
+    {
+        // the hand tuned weights, and random variations of them
+        std::mt19937 rng(0);
+        std::normal_distribution<double> noise(0, 0.3);
+        for (int i = 0; i < populationSize; i++)
+        {
+            individual x;
+            if (i)
+                for (int k = 0; k < FEATURE_COUNT; k++)
+                    x.weights.w[k] += noise(rng);
+            normalize(x.weights);
+            x.fitness = 0;
+            population.push_back(x);
+        }
+    }
+
+    for (; generation < generations; generation++)
+    {
+        // new games every generation, the same ones for the whole population
+        std::mt19937 rng(generation * 7919 + 1);
+        unsigned long long seed = (unsigned long long)generation * games * 104729 + 1;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        evaluate(population, games, pieces, seed, threadCount);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const individual &best = *std::max_element(population.begin(), population.end(), [](const individual &a, const individual &b)
+                                                    { return a.fitness < b.fitness; });
+        std::cout << "generation " << generation << ": best " << std::fixed << std::setprecision(0) << best.fitness
+                  << " (" << std::setprecision(2) << elapsed << " s)";
+        for (int k = 0; k < FEATURE_COUNT; k++)
+            std::cout << " " << FEATURE_NAMES[k] << "=" << std::setprecision(3) << best.weights.w[k];
+        std::cout << std::endl;
+
+        population = breed(population, rng);
+        if (!saveCheckpoint(checkpoint, generation + 1, population))
+            std::cerr << "cannot save " << checkpoint << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifndef VERSUS_H
+#define VERSUS_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+
+// lines of garbage sent for clearing 0, 1, 2, 3 or 4 lines at once
+const int ATTACK[5] = {0, 0, 1, 2, 4};
+
+// one or two games played side by side, lines cleared by one player are sent to the other as garbage
+struct versus
+{
+    int players;
+    Game games[2];
+    int garbage[2];         // garbage lines waiting to be added to the player's board
+    int locked[2], line[2]; // counters of the games when they were last settled
+
+    versus(const int &_players = 2, const unsigned long long &seed = std::rand())
+    {
+        players = _players;
+        for (int p = 0; p < 2; p++)
+        {
+            // both players get the same bags
+            games[p] = Game(seed);
+            garbage[p] = 0, locked[p] = 0, line[p] = 0;
+        }
+    }
+};
+
+// call after updating a player's game: exchange garbage if a tetromino has been locked
+// return the garbage lines sent to the opponent, or -1 if nothing was locked
+int settleVersus(versus &v, const int &p)
+{
+    Game &g = v.games[p];
+    if (g.locked == v.locked[p])
+        return -1;
+
+    // send the lines cleared as garbage, after cancelling our own
+    int cleared = g.line - v.line[p];
+    v.locked[p] = g.locked, v.line[p] = g.line;
+    int attack = ATTACK[std::min(cleared, 4)];
+    int cancel = std::min(attack, v.garbage[p]);
+    v.garbage[p] -= cancel, attack -= cancel;
+    if (v.players == 2)
+        v.garbage[1 - p] += attack;
+    else
+        attack = 0;
+
+    // the garbage comes up when the player locks a tetromino without clearing anything
+    if (!cleared && v.garbage[p])
+    {
+        if (!addGarbage(g.boardStates, v.garbage[p], nextRandom(g.seed, COLUMN)) || isEnd(g.boardStates))
+            g.isPlaying = 0;
+        v.garbage[p] = 0;
+    }
+    return attack;
+}
+
+#endif
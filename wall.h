@@ -0,0 +1,181 @@
+#ifndef WALL_H
+#define WALL_H
+
+#include <SFML/Graphics.hpp>
+#include <bits/stdc++.h>
+
+#include "game.h"
+#include "render.h"
+
+/*
+    Spectator wall: many boards tiled in one window
+    - every cell of every board is a quad in a few big vertex arrays textured with Tetromino.png,
+      so the whole wall is a handful of draw calls instead of one per block
+    - a board only rewrites its quads when its view has changed since the last frame
+    - when the boards get small, the texture is dropped for flat colors, and when they get tiny,
+      the cells of a row with the same color are merged into one quad
+*/
+
+const int TILES_PER_BATCH = 16;
+const int TILE_QUADS = ROWS * COLUMN;
+const float TEXTURE_LOD = 8; // smallest cell, in pixels, still drawn with the texture
+const float MERGE_LOD = 4;   // below this, runs of cells are merged
+
+// what the wall needs from a game, small enough to be copied around every tick
+struct boardView
+{
+    unsigned char cells[ROWS][COLUMN]; // 0 if empty, color + 1 otherwise, the falling tetromino included
+    int score, line;
+    bool over;
+    unsigned int version; // changes whenever the rest does
+    boardView()
+    {
+        memset(cells, 0, sizeof(cells));
+        score = 0, line = 0, over = 0, version = 0;
+    }
+};
+
+// refresh v from g, return 1 if anything changed
+bool makeView(const Game &g, boardView &v)
+{
+    unsigned char cells[ROWS][COLUMN];
+    for (int i = 0; i < ROWS; i++)
+        for (int j = 0; j < COLUMN; j++)
+            cells[i][j] = g.boardStates[i][j];
+    bool over = !g.isPlaying && isEnd(g.boardStates);
+    if (g.gameStarted && !over)
+        for (int i = 0; i < 4; i++)
+            if (isInside(g.tetra.block[i], point(0, 0), point(COLUMN - 1, ROWS - 1)))
+                cells[g.tetra.block[i].y][g.tetra.block[i].x] = g.tetra.color + 1;
+    if (!memcmp(cells, v.cells, sizeof(cells)) && v.score == g.score && v.over == over)
+        return 0;
+    memcpy(v.cells, cells, sizeof(cells));
+    v.score = g.score, v.line = g.line, v.over = over;
+    v.version++;
+    return 1;
+}
+
+struct spectatorWall
+{
+    int count, columns, rows;
+    float cell;                          // cell size in pixels
+    std::vector<sf::Vector2f> origin;    // top left corner of every board
+    std::vector<sf::VertexArray> batches;
+    std::vector<long long> drawn;        // version drawn for every board, -1 to force a rebuild
+    sf::VertexArray frames;              // backgrounds of the boards, one untextured batch
+    sf::Color flat[GARBAGE + 1];         // average color of every block, for the flat level of detail
+    long long rebuilt;                   // boards rewritten so far, for statistics
+
+    spectatorWall(const int &_count, const sf::Texture &atlas)
+    {
+        count = _count, columns = 1, rows = 1, cell = 1, rebuilt = 0;
+        origin.resize(count);
+        drawn.assign(count, -1);
+        batches.assign((count + TILES_PER_BATCH - 1) / TILES_PER_BATCH, sf::VertexArray(sf::Quads, 0));
+        for (int b = 0; b < (int)batches.size(); b++)
+            batches[b].resize(std::min(TILES_PER_BATCH, count - b * TILES_PER_BATCH) * TILE_QUADS * 4);
+
+        // average the atlas once, garbage is gray like in drawBlock()
+        sf::Image image = atlas.copyToImage();
+        const sf::Uint8 *pixels = image.getPixelsPtr();
+        for (int c = 0; c < GARBAGE; c++)
+        {
+            long long sum[3] = {0, 0, 0};
+            if (pixels && image.getSize().x >= (unsigned)(GARBAGE * BLOCK_SIZE) && image.getSize().y >= (unsigned)BLOCK_SIZE)
+                for (int y = 0; y < BLOCK_SIZE; y++)
+                    for (int x = c * BLOCK_SIZE; x < (c + 1) * BLOCK_SIZE; x++)
+                        for (int k = 0; k < 3; k++)
+                            sum[k] += pixels[(y * image.getSize().x + x) * 4 + k];
+            int n = BLOCK_SIZE * BLOCK_SIZE;
+            flat[c] = sf::Color(sum[0] / n, sum[1] / n, sum[2] / n);
+        }
+        flat[GARBAGE] = sf::Color(110, 110, 110);
+    }
+
+    // fit the boards in a width x height window, as big as possible
+    void layout(const float &width, const float &height)
+    {
+        const float gap = 1; // in cells, around every board
+        cell = 0;
+        for (int c = 1; c <= count; c++)
+        {
+            int r = (count + c - 1) / c;
+            float size = std::min(width / (c * (COLUMN + gap)), height / (r * (ROWS + gap)));
+            if (size > cell)
+                cell = size, columns = c, rows = r;
+        }
+        // cells of a whole number of pixels keep the grid sharp
+        if (cell >= 2)
+            cell = std::floor(cell);
+
+        float left = (width - columns * (COLUMN + gap) * cell) / 2, top = (height - rows * (ROWS + gap) * cell) / 2;
+        frames = sf::VertexArray(sf::Quads, count * 4);
+        for (int i = 0; i < count; i++)
+        {
+            origin[i] = sf::Vector2f(left + (i % columns * (COLUMN + gap) + gap / 2) * cell,
+                                     top + (i / columns * (ROWS + gap) + gap / 2) * cell);
+            setQuad(&frames[i * 4], origin[i].x, origin[i].y, COLUMN * cell, ROWS * cell, sf::Color(30, 30, 30), -1);
+        }
+        drawn.assign(count, -1);
+    }
+
+    void setQuad(sf::Vertex *quad, const float &x, const float &y, const float &w, const float &h, const sf::Color &color, const int &type)
+    {
+        quad[0].position = sf::Vector2f(x, y);
+        quad[1].position = sf::Vector2f(x + w, y);
+        quad[2].position = sf::Vector2f(x + w, y + h);
+        quad[3].position = sf::Vector2f(x, y + h);
+        for (int k = 0; k < 4; k++)
+            quad[k].color = color;
+        if (type < 0)
+            return;
+        float u = (type == GARBAGE ? 0 : type) * BLOCK_SIZE;
+        quad[0].texCoords = sf::Vector2f(u, 0);
+        quad[1].texCoords = sf::Vector2f(u + BLOCK_SIZE, 0);
+        quad[2].texCoords = sf::Vector2f(u + BLOCK_SIZE, BLOCK_SIZE);
+        quad[3].texCoords = sf::Vector2f(u, BLOCK_SIZE);
+    }
+
+    // rewrite the quads of board i if its view is newer than what is drawn
+    void update(const int &i, const boardView &v)
+    {
+        if (drawn[i] == v.version)
+            return;
+        drawn[i] = v.version;
+        rebuilt++;
+
+        sf::Vertex *quad = &batches[i / TILES_PER_BATCH][i % TILES_PER_BATCH * TILE_QUADS * 4];
+        sf::Vertex *end = quad + TILE_QUADS * 4;
+        bool textured = cell >= TEXTURE_LOD, merged = cell < MERGE_LOD;
+        sf::Uint8 shade = v.over ? 90 : 255; // topped out boards are dimmed
+        for (int y = 0; y < ROWS; y++)
+            for (int x = 0; x < COLUMN; x++)
+            {
+                int c = v.cells[y][x];
+                if (!c)
+                    continue;
+                int run = 1;
+                if (merged)
+                    while (x + run < COLUMN && v.cells[y][x + run] == c)
+                        run++;
+                sf::Color color = textured ? (c - 1 == GARBAGE ? flat[GARBAGE] : sf::Color::White) : flat[c - 1];
+                color.r = color.r * shade / 255, color.g = color.g * shade / 255, color.b = color.b * shade / 255;
+                setQuad(quad, origin[i].x + x * cell, origin[i].y + y * cell, run * cell, cell, color, c - 1);
+                quad += 4;
+                x += run - 1;
+            }
+        // the quads left are collapsed, they cost nothing to draw
+        for (; quad != end; quad++)
+            quad->position = sf::Vector2f(0, 0);
+    }
+
+    void draw(sf::RenderTarget &target, const sf::Texture &atlas)
+    {
+        target.draw(frames);
+        const sf::Texture *texture = cell >= TEXTURE_LOD ? &atlas : nullptr;
+        for (size_t b = 0; b < batches.size(); b++)
+            target.draw(batches[b], sf::RenderStates(texture));
+    }
+};
+
+#endif